@@ -0,0 +1,127 @@
+/*
+ * app_hash.c - Cached hashes of the resident application image
+ *
+ * The scan walks the application region one row at a time, storing
+ * each row's CRC32 and feeding the row into a private SHA‑256 context
+ * so the firmware hash used by the WRITE/DONE path is left untouched.
+ * Once the last row is hashed the image digest is finalised and kept
+ * alongside the row table.
+ *
+ * Each row CRC has its own valid bit.  A WRITE clears only the bits of
+ * the rows it covers, and `CRC <addr>` recomputes just the requested
+ * row, so verify-after-write stays cheap.  The digest covers the whole
+ * region and is rescanned only when HASH APP asks for it after a
+ * change.
+ */
+
+#include "app_hash.h"
+#include "crypto_ops.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+static enum {
+    APP_HASH_SCANNING, /* idle steps are hashing rows              */
+    APP_HASH_READY,    /* digest is valid                          */
+    APP_HASH_STALE     /* flash changed; rescan on HASH APP        */
+} app_hash_state;
+
+static uint32_t            next_row;
+static uint32_t            row_crc[APP_HASH_ROWS];
+static uint32_t            row_valid[(APP_HASH_ROWS + 31u) / 32u];
+static uint8_t             image_digest[32];
+static crypto_sha256_ctx_t image_ctx;
+
+static const uint8_t *
+row_data(uint32_t row)
+{
+    return (const uint8_t *)(APP_START_ADDRESS + row * FLASH_ROW_SIZE);
+}
+
+static bool
+row_is_valid(uint32_t row)
+{
+    return (row_valid[row / 32u] & (1UL << (row % 32u))) != 0u;
+}
+
+/* Compute and cache the CRC32 of one row. */
+static uint32_t
+row_update(uint32_t row)
+{
+    row_crc[row] = crypto_crc32_update(0xFFFFFFFFUL, row_data(row), FLASH_ROW_SIZE) ^
+                   0xFFFFFFFFUL;
+    row_valid[row / 32u] |= 1UL << (row % 32u);
+    return row_crc[row];
+}
+
+void
+app_hash_init(void)
+{
+    next_row = 0;
+    crypto_sha256_ctx_init(&image_ctx);
+    app_hash_state = APP_HASH_SCANNING;
+}
+
+bool
+app_hash_idle_step(void)
+{
+    if (app_hash_state != APP_HASH_SCANNING) {
+        return false;
+    }
+
+    /* Rows the host already asked for keep their cached CRC. */
+    if (!row_is_valid(next_row)) {
+        row_update(next_row);
+    }
+    crypto_sha256_ctx_update(&image_ctx, row_data(next_row), FLASH_ROW_SIZE);
+
+    if (++next_row < APP_HASH_ROWS) {
+        return true;
+    }
+
+    crypto_sha256_ctx_final(&image_ctx, image_digest);
+    app_hash_state = APP_HASH_READY;
+    return false;
+}
+
+void
+app_hash_invalidate(void)
+{
+    memset(row_valid, 0, sizeof(row_valid));
+    app_hash_state = APP_HASH_STALE;
+}
+
+void
+app_hash_invalidate_range(uint32_t addr, uint32_t len)
+{
+    if (len == 0u) {
+        return;
+    }
+    uint32_t first = (addr - APP_START_ADDRESS) / FLASH_ROW_SIZE;
+    uint32_t last = (addr + len - 1u - APP_START_ADDRESS) / FLASH_ROW_SIZE;
+    for (uint32_t row = first; row <= last && row < APP_HASH_ROWS; row++) {
+        row_valid[row / 32u] &= ~(1UL << (row % 32u));
+    }
+    app_hash_state = APP_HASH_STALE;
+}
+
+uint32_t
+app_hash_row_crc(uint32_t row_addr)
+{
+    uint32_t row = (row_addr - APP_START_ADDRESS) / FLASH_ROW_SIZE;
+    if (row_is_valid(row)) {
+        return row_crc[row];
+    }
+    return row_update(row);
+}
+
+void
+app_hash_digest(uint8_t digest[32])
+{
+    if (app_hash_state == APP_HASH_STALE) {
+        app_hash_init();
+    }
+    while (app_hash_idle_step()) {
+    }
+    memcpy(digest, image_digest, sizeof(image_digest));
+}
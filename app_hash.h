@@ -0,0 +1,55 @@
+/*
+ * app_hash.h - Cached hashes of the resident application image
+ *
+ * After entering bootloader mode the device is idle until the host
+ * tool opens the port and starts talking.  That idle time is used to
+ * compute the CRC32 of every application row and the SHA‑256 digest of
+ * the whole application region, so that verify and skip-if-identical
+ * queries can be answered from RAM instead of rescanning flash.
+ *
+ * Optional, built when BOOT_APP_HASH is defined (`make APP_HASH=1`, the
+ * default for 16 and 32 KB bootloaders).
+ */
+
+#ifndef APP_HASH_H
+#define APP_HASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "boot_config.h"
+#include "flash_ops.h"
+
+/* Number of flash rows in the application region. */
+#define APP_HASH_ROWS ((FLASH_SIZE - APP_START_ADDRESS) / FLASH_ROW_SIZE)
+
+/* Start a fresh scan of the application region from its first row. */
+void app_hash_init(void);
+
+/* Hash one more row if a scan is in progress.  Intended to be called
+ * from the main loop whenever no host data is pending; each call costs
+ * one row worth of CRC32 and SHA‑256 work.  Returns true while rows
+ * remain to be hashed. */
+bool app_hash_idle_step(void);
+
+/* Drop all cached values because the application region has been
+ * modified (erased, or written by an applet).  Row CRCs are recomputed
+ * on demand; no further idle work is done so an update in progress is
+ * not slowed down. */
+void app_hash_invalidate(void);
+
+/* Drop the cached CRCs of the rows overlapping `len` bytes at `addr`
+ * and the image digest.  Used for WRITE, which leaves other rows
+ * untouched. */
+void app_hash_invalidate_range(uint32_t addr, uint32_t len);
+
+/* Return the CRC32 of the row starting at `row_addr`, which must be
+ * row aligned and inside the application region.  Only that row is
+ * read from flash if its value is not cached. */
+uint32_t app_hash_row_crc(uint32_t row_addr);
+
+/* Return the SHA‑256 digest of the full application region
+ * (APP_START_ADDRESS up to FLASH_SIZE), completing the scan first if
+ * needed.  After a change this rescans the whole region. */
+void app_hash_digest(uint8_t digest[32]);
+
+#endif /* APP_HASH_H */
@@ -0,0 +1,111 @@
+/*
+ * applet.c - Signed RAM applets
+ *
+ * The upload buffer lives in its own .applet section, which the linker
+ * script places at the very start of SRAM so applets can be linked for
+ * a fixed address.  Nothing is executed until the signature over the
+ * buffer has been checked.
+ */
+
+#include "applet.h"
+#include "flash_ops.h"
+#include "app_hash.h"
+#include <string.h>
+
+/* Provided by the USB layer */
+extern void usb_task(void);
+extern int  usb_cdc_getchar(void);
+extern void usb_cdc_write(const uint8_t *data, size_t len);
+
+static uint8_t applet_image[APPLET_MAX_SIZE]
+    __attribute__((section(".applet"), aligned(4)));
+
+static uint32_t applet_len;      /* announced size of the upload */
+static uint32_t applet_received; /* bytes stored so far          */
+
+static const char applet_domain[16] = "ZeroBoot applet";
+
+static const applet_services_t applet_services = {
+    .version           = APPLET_SERVICES_VERSION,
+    .usb_task          = usb_task,
+    .usb_cdc_getchar   = usb_cdc_getchar,
+    .usb_cdc_write     = usb_cdc_write,
+    .flash_erase_range = flash_erase_range,
+    .flash_write       = flash_write,
+    .flash_cache_write = flash_cache_write,
+    .flash_cache_flush = flash_cache_flush,
+    .sha256_init       = crypto_sha256_ctx_init,
+    .sha256_update     = crypto_sha256_ctx_update,
+    .sha256_final      = crypto_sha256_ctx_final,
+    .crc32_update      = crypto_crc32_update,
+    .ed25519_verify    = crypto_ed25519_verify,
+    .image_hash_update = crypto_sha256_update,
+};
+
+bool
+applet_begin(uint32_t len)
+{
+    applet_len = 0;
+    applet_received = 0;
+    if (len > APPLET_MAX_SIZE) {
+        return false;
+    }
+    applet_len = len;
+    return true;
+}
+
+size_t
+applet_data(const uint8_t *data, size_t len)
+{
+    size_t want = applet_len - applet_received;
+    size_t used = (len < want) ? len : want;
+    memcpy(&applet_image[applet_received], data, used);
+    applet_received += (uint32_t)used;
+    return used;
+}
+
+uint32_t
+applet_remaining(void)
+{
+    return applet_len - applet_received;
+}
+
+applet_status_t
+applet_run(const uint8_t signature[64], const char *args, int *ret)
+{
+    if (applet_len == 0 || applet_received != applet_len) {
+        return APPLET_ERR_EMPTY;
+    }
+
+    /* Hash with a private context; the firmware hash may be mid-update. */
+    crypto_sha256_ctx_t ctx;
+    uint8_t digest[32];
+    crypto_sha256_ctx_init(&ctx);
+    crypto_sha256_ctx_update(&ctx, (const uint8_t *)applet_domain,
+                             sizeof(applet_domain));
+    crypto_sha256_ctx_update(&ctx, applet_image, applet_len);
+    crypto_sha256_ctx_final(&ctx, digest);
+    if (!crypto_ed25519_verify(signature, digest)) {
+        return APPLET_ERR_SIGNATURE;
+    }
+
+    const applet_header_t *hdr = (const applet_header_t *)applet_image;
+    uint32_t base  = (uint32_t)(uintptr_t)applet_image;
+    uint32_t entry = hdr->entry & ~1UL;
+    if (applet_len < sizeof(*hdr) || hdr->magic != APPLET_MAGIC ||
+        (hdr->entry & 1UL) == 0UL || entry < base + sizeof(*hdr) ||
+        entry >= base + applet_len) {
+        return APPLET_ERR_FORMAT;
+    }
+
+    /* Give the applet a settled view of flash, and assume afterwards
+     * that it changed the application region. */
+    flash_cache_flush();
+    applet_entry_t fn = (applet_entry_t)(uintptr_t)hdr->entry;
+    *ret = fn(&applet_services, (args != NULL) ? args : "");
+    flash_cache_flush();
+#ifdef BOOT_APP_HASH
+    app_hash_invalidate();
+#endif
+    return APPLET_OK;
+}
@@ -0,0 +1,107 @@
+/*
+ * applet.h - Signed RAM applets
+ *
+ * Optional, built when BOOT_APPLET is defined (`make APPLET=1`, the
+ * default for 16 and 32 KB bootloaders).
+ *
+ * An applet is a small piece of position-dependent Thumb code linked to
+ * run at APPLET_ADDRESS (see tools/applet.ld).  The host uploads it with
+ * `APPLET <len> <crc32>` followed by the binary, then starts it with
+ * `RUN <signature_hex> [args]`.  The signature is Ed25519 with the
+ * bootloader key over
+ *
+ *     SHA‑256("ZeroBoot applet\0" || applet bytes)
+ *
+ * The prefix keeps applet signatures and firmware signatures apart, so
+ * a signed firmware image can never be started as an applet.  Applets
+ * let update-time work that needs a lot of code or tables (decompression,
+ * delta patching, faster verification) run without growing the resident
+ * bootloader.
+ *
+ * The image starts with an applet_header_t.  The entry function is
+ * called on the bootloader stack with the services table and the
+ * optional argument string from the RUN line.  The arguments are not
+ * covered by the signature.  Host data after the RUN line is left for
+ * the applet to read.  Its return value is reported to the host as
+ * `OK RUN <ret>`.
+ */
+
+#ifndef APPLET_H
+#define APPLET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "boot_config.h"
+#include "crypto_ops.h"
+
+/* First word of every applet image ("ZBAP" in memory). */
+#define APPLET_MAGIC            0x5041425AUL
+
+/* Bumped whenever applet_services_t changes incompatibly.  Entries are
+ * only ever appended, so an applet may use any service whose version is
+ * at most svc->version. */
+#define APPLET_SERVICES_VERSION 1u
+
+/* Bootloader functions an applet may call. */
+typedef struct {
+    uint32_t version;
+
+    /* Host link (see usb_stubs.c).  usb_task() must be called while an
+     * applet waits for host data. */
+    void     (*usb_task)(void);
+    int      (*usb_cdc_getchar)(void);
+    void     (*usb_cdc_write)(const uint8_t *data, size_t len);
+
+    /* Flash (see flash_ops.h).  The write-combining cache is empty when
+     * the applet starts and must be flushed before it returns. */
+    void     (*flash_erase_range)(uint32_t addr, size_t len);
+    void     (*flash_write)(uint32_t addr, const uint8_t *data, size_t len);
+    void     (*flash_cache_write)(uint32_t addr, const uint8_t *data, size_t len);
+    void     (*flash_cache_flush)(void);
+
+    /* Crypto (see crypto_ops.h). */
+    void     (*sha256_init)(crypto_sha256_ctx_t *ctx);
+    void     (*sha256_update)(crypto_sha256_ctx_t *ctx, const uint8_t *data, size_t len);
+    void     (*sha256_final)(crypto_sha256_ctx_t *ctx, uint8_t digest[32]);
+    uint32_t (*crc32_update)(uint32_t crc, const uint8_t *data, size_t len);
+    bool     (*ed25519_verify)(const uint8_t signature[64], const uint8_t hash[32]);
+
+    /* Feed bytes into the firmware hash checked by DONE, for applets
+     * that write the application themselves (e.g. a decompressor). */
+    void     (*image_hash_update)(const uint8_t *data, size_t len);
+} applet_services_t;
+
+typedef int (*applet_entry_t)(const applet_services_t *svc, const char *args);
+
+/* Layout of the start of an applet image. */
+typedef struct {
+    uint32_t magic; /* APPLET_MAGIC                                  */
+    uint32_t entry; /* address of the entry function, Thumb bit set  */
+} applet_header_t;
+
+/* Result of applet_run(). */
+typedef enum {
+    APPLET_OK,            /* applet ran; *ret holds its return value      */
+    APPLET_ERR_EMPTY,     /* nothing uploaded                             */
+    APPLET_ERR_SIGNATURE, /* signature does not match the uploaded bytes  */
+    APPLET_ERR_FORMAT     /* bad magic or entry outside the image         */
+} applet_status_t;
+
+/* Start receiving an applet of `len` bytes, discarding any previous
+ * one.  Returns false if it does not fit APPLET_MAX_SIZE. */
+bool applet_begin(uint32_t len);
+
+/* Append received bytes.  Returns the number consumed (never more than
+ * the announced length still outstanding). */
+size_t applet_data(const uint8_t *data, size_t len);
+
+/* Number of bytes still expected for the applet being received. */
+uint32_t applet_remaining(void);
+
+/* Verify the uploaded applet against `signature` and call it.  The
+ * applet is hashed again on every run, so a blob that modified itself
+ * will not verify a second time. */
+applet_status_t applet_run(const uint8_t signature[64], const char *args, int *ret);
+
+#endif /* APPLET_H */
@@ -10,10 +10,40 @@
  */
 
 /*
- * Address where the main application image begins. The first 8 KiB of
- * flash (0x0000 - 0x1FFF) are reserved for the bootloader, so the
- * application vectors and code start at 0x2000.
+ * Size of the bootloader region in KiB, set by the makefile from
+ * BOOT_SIZE (which also sizes the FLASH region in samd21_boot.ld).  It
+ * must be one of the sizes the BOOTPROT fuse can protect.  The default
+ * 8 KiB layout is the one existing applications are linked for.
  */
-#define APP_START_ADDRESS 0x00002000UL
+#ifndef BOOTLOADER_KB
+#define BOOTLOADER_KB 8
+#endif
+
+#if (BOOTLOADER_KB != 8) && (BOOTLOADER_KB != 16) && (BOOTLOADER_KB != 32)
+#error "BOOTLOADER_KB must be 8, 16 or 32"
+#endif
+
+#define BOOTLOADER_SIZE   (BOOTLOADER_KB * 1024UL)
+
+/*
+ * Address where the main application image begins: right after the
+ * bootloader region (0x2000 for the 8 KiB layout, 0x4000 for 16 KiB).
+ */
+#define APP_START_ADDRESS BOOTLOADER_SIZE
+
+/*
+ * The last row of the bootloader region holds no code (the linker
+ * script stops FLASH short of it).  Its last word is the application
+ * valid flag checked by main.c and written by flash_set_app_valid_flag().
+ */
+#define APP_VALID_FLAG_ADDRESS (APP_START_ADDRESS - 4UL)
+
+/*
+ * RAM applets (see applet.h) are uploaded to a fixed buffer at the start
+ * of SRAM.  samd21_boot.ld places the .applet section there and checks
+ * that it matches APPLET_ADDRESS; tools/applet.ld links applets for it.
+ */
+#define APPLET_ADDRESS    0x20000000UL
+#define APPLET_MAX_SIZE   4096U
 
 #endif /* BOOT_CONFIG_H */
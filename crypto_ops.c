@@ -9,12 +9,17 @@
  */
 
 #include "crypto_ops.h"
+#include "ramfunc.h"
 #include <string.h>
 
 #if defined(__GNUC__)
 #define UNUSED __attribute__((unused))
+/* For the small helpers of the RAMFUNC kernels: -Os may otherwise
+ * leave an out-of-line copy in flash that the SRAM code calls. */
+#define ALWAYS_INLINE inline __attribute__((always_inline))
 #else
 #define UNUSED
+#define ALWAYS_INLINE inline
 #endif
 
 /* -------------------------------------------------------------------------
@@ -33,31 +38,31 @@
 #if defined(__SIZEOF_INT128__)
 typedef __uint128_t fe_u128;
 
-static inline fe_u128
+static ALWAYS_INLINE fe_u128
 fe_u128_add(fe_u128 a, fe_u128 b)
 {
     return a + b;
 }
 
-static inline fe_u128
+static ALWAYS_INLINE fe_u128
 fe_u128_add_u64(fe_u128 a, uint64_t b)
 {
     return a + (fe_u128)b;
 }
 
-static inline fe_u128
+static ALWAYS_INLINE fe_u128
 fe_u128_mul64(uint64_t a, uint64_t b)
 {
     return (fe_u128)a * (fe_u128)b;
 }
 
-static inline uint64_t
+static ALWAYS_INLINE uint64_t
 fe_u128_lo(fe_u128 a)
 {
     return (uint64_t)a;
 }
 
-static inline uint64_t
+static ALWAYS_INLINE uint64_t
 fe_u128_shr_u64(fe_u128 a, unsigned shift)
 {
     return (uint64_t)(a >> shift);
@@ -68,7 +73,7 @@ typedef struct {
     uint64_t hi;
 } fe_u128;
 
-static inline fe_u128
+static ALWAYS_INLINE fe_u128
 fe_u128_add(fe_u128 a, fe_u128 b)
 {
     fe_u128 r;
@@ -77,7 +82,7 @@ fe_u128_add(fe_u128 a, fe_u128 b)
     return r;
 }
 
-static inline fe_u128
+static ALWAYS_INLINE fe_u128
 fe_u128_add_u64(fe_u128 a, uint64_t b)
 {
     fe_u128 r;
@@ -86,8 +91,10 @@ fe_u128_add_u64(fe_u128 a, uint64_t b)
     return r;
 }
 
-static inline fe_u128
-fe_u128_mul64(uint64_t a, uint64_t b)
+/* Hot on targets without a 64x64 multiplier, so it runs from SRAM
+ * together with fe51_mul(). */
+static fe_u128
+RAMFUNC(fe_u128_mul64)(uint64_t a, uint64_t b)
 {
     uint64_t alo = (uint32_t)a;
     uint64_t ahi = a >> 32;
@@ -110,13 +117,13 @@ fe_u128_mul64(uint64_t a, uint64_t b)
     return r;
 }
 
-static inline uint64_t
+static ALWAYS_INLINE uint64_t
 fe_u128_lo(fe_u128 a)
 {
     return a.lo;
 }
 
-static inline uint64_t
+static ALWAYS_INLINE uint64_t
 fe_u128_shr_u64(fe_u128 a, unsigned shift)
 {
     if (shift == 0) {
@@ -141,13 +148,22 @@ fe_u128_shr_u64(fe_u128 a, unsigned shift)
 #define SIG0(x)       (ROTR32((x), 7) ^ ROTR32((x), 18) ^ ((x) >> 3))
 #define SIG1(x)       (ROTR32((x), 17) ^ ROTR32((x), 19) ^ ((x) >> 10))
 
+/* One round with the roles of the working variables given by the
+ * caller: d receives the new e and h the new a. */
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, i) do {                   \
+        uint32_t t1_ = (h) + EP1(e) + CH((e), (f), (g)) +              \
+                       sha256_k[i] + w[i];                             \
+        (d) += t1_;                                                    \
+        (h) = t1_ + EP0(a) + MAJ((a), (b), (c));                       \
+    } while (0)
+
 /* Initial hash values (H0..H7) and round constants (K) from FIPS 180-4. */
 static const uint32_t sha256_initial_state[8] = {
     0x6A09E667u, 0xBB67AE85u, 0x3C6EF372u, 0xA54FF53Au,
     0x510E527Fu, 0x9B05688Cu, 0x1F83D9ABu, 0x5BE0CD19u
 };
 
-static const uint32_t sha256_k[64] = {
+static const uint32_t RAMDATA(sha256_k)[64] = {
     0x428A2F98u, 0x71374491u, 0xB5C0FBCFu, 0xE9B5DBA5u,
     0x3956C25Bu, 0x59F111F1u, 0x923F82A4u, 0xAB1C5ED5u,
     0xD807AA98u, 0x12835B01u, 0x243185BEu, 0x550C7DC3u,
@@ -163,46 +179,48 @@ static const uint32_t sha256_k[64] = {
     0x19A4C116u, 0x1E376C08u, 0x2748774Cu, 0x34B0BCB5u,
     0x391C0CB3u, 0x4ED8AA4Au, 0x5B9CCA4Fu, 0x682E6FF3u,
     0x748F82EEu, 0x78A5636Fu, 0x84C87814u, 0x8CC70208u,
-    0x90BEFFF9u, 0xA4506CEBu, 0xBEF9A3F7u, 0xC67178F2u
+    0x90BEFFFAu, 0xA4506CEBu, 0xBEF9A3F7u, 0xC67178F2u
 };
 
-/* Internal state for SHA‑256 consisting of the eight working words,
- * a 64-byte buffer for partial blocks, and the total number of bytes
- * processed so far.  The state is kept static so the bootloader does
- * not require dynamic allocation. */
-static struct {
-    uint32_t h[8];
-    uint8_t  buffer[64];
-    size_t   buffer_len;
-    uint64_t total_len;
-} sha_ctx;
+/* Internal SHA‑256 context used by the context-free API to hash the
+ * firmware image.  It is kept static so the bootloader does not require
+ * dynamic allocation. */
+static crypto_sha256_ctx_t sha_ctx;
 
+/* Run one compression on a message schedule whose first 16 words have
+ * already been loaded (big-endian) by the caller. */
 static void
-crypto_sha256_process_block(const uint8_t block[64])
+RAMFUNC(crypto_sha256_compress)(crypto_sha256_ctx_t *ctx, uint32_t w[64])
 {
-    uint32_t w[64];
     uint32_t a, b, c, d, e, f, g, h;
 
-    for (size_t i = 0; i < 16; i++) {
-        size_t j = i * 4;
-        w[i] = ((uint32_t)block[j] << 24) |
-               ((uint32_t)block[j + 1] << 16) |
-               ((uint32_t)block[j + 2] << 8) |
-               ((uint32_t)block[j + 3]);
-    }
     for (size_t i = 16; i < 64; i++) {
         w[i] = SIG1(w[i - 2]) + w[i - 7] + SIG0(w[i - 15]) + w[i - 16];
     }
 
-    a = sha_ctx.h[0];
-    b = sha_ctx.h[1];
-    c = sha_ctx.h[2];
-    d = sha_ctx.h[3];
-    e = sha_ctx.h[4];
-    f = sha_ctx.h[5];
-    g = sha_ctx.h[6];
-    h = sha_ctx.h[7];
-
+    a = ctx->h[0];
+    b = ctx->h[1];
+    c = ctx->h[2];
+    d = ctx->h[3];
+    e = ctx->h[4];
+    f = ctx->h[5];
+    g = ctx->h[6];
+    h = ctx->h[7];
+
+#ifdef BOOT_FAST
+    /* Eight rounds per pass; renaming the working variables instead of
+     * shifting them saves six moves per round. */
+    for (size_t i = 0; i < 64; i += 8) {
+        SHA256_ROUND(a, b, c, d, e, f, g, h, i + 0);
+        SHA256_ROUND(h, a, b, c, d, e, f, g, i + 1);
+        SHA256_ROUND(g, h, a, b, c, d, e, f, i + 2);
+        SHA256_ROUND(f, g, h, a, b, c, d, e, i + 3);
+        SHA256_ROUND(e, f, g, h, a, b, c, d, i + 4);
+        SHA256_ROUND(d, e, f, g, h, a, b, c, i + 5);
+        SHA256_ROUND(c, d, e, f, g, h, a, b, i + 6);
+        SHA256_ROUND(b, c, d, e, f, g, h, a, i + 7);
+    }
+#else
     for (size_t i = 0; i < 64; i++) {
         uint32_t temp1 = h + EP1(e) + CH(e, f, g) + sha256_k[i] + w[i];
         uint32_t temp2 = EP0(a) + MAJ(a, b, c);
@@ -215,94 +233,258 @@ crypto_sha256_process_block(const uint8_t block[64])
         b = a;
         a = temp1 + temp2;
     }
+#endif
 
-    sha_ctx.h[0] += a;
-    sha_ctx.h[1] += b;
-    sha_ctx.h[2] += c;
-    sha_ctx.h[3] += d;
-    sha_ctx.h[4] += e;
-    sha_ctx.h[5] += f;
-    sha_ctx.h[6] += g;
-    sha_ctx.h[7] += h;
+    ctx->h[0] += a;
+    ctx->h[1] += b;
+    ctx->h[2] += c;
+    ctx->h[3] += d;
+    ctx->h[4] += e;
+    ctx->h[5] += f;
+    ctx->h[6] += g;
+    ctx->h[7] += h;
+}
+
+static void
+crypto_sha256_process_block(crypto_sha256_ctx_t *ctx, const uint8_t block[64])
+{
+    uint32_t w[64];
+
+    for (size_t i = 0; i < 16; i++) {
+        size_t j = i * 4;
+        w[i] = ((uint32_t)block[j] << 24) |
+               ((uint32_t)block[j + 1] << 16) |
+               ((uint32_t)block[j + 2] << 8) |
+               ((uint32_t)block[j + 3]);
+    }
+    crypto_sha256_compress(ctx, w);
 }
 
 void
-crypto_sha256_init(void)
+crypto_sha256_ctx_init(crypto_sha256_ctx_t *ctx)
 {
-    memcpy(sha_ctx.h, sha256_initial_state, sizeof(sha_ctx.h));
-    sha_ctx.buffer_len = 0;
-    sha_ctx.total_len = 0;
+    memcpy(ctx->h, sha256_initial_state, sizeof(ctx->h));
+    ctx->buffer_len = 0;
+    ctx->total_len = 0;
 }
 
 void
-crypto_sha256_update(const uint8_t *data, size_t len)
+crypto_sha256_ctx_update(crypto_sha256_ctx_t *ctx, const uint8_t *data, size_t len)
 {
     if (len == 0) {
         return;
     }
 
-    sha_ctx.total_len += len;
+    ctx->total_len += len;
 
     size_t offset = 0;
-    if (sha_ctx.buffer_len > 0) {
-        size_t space = 64u - sha_ctx.buffer_len;
+    if (ctx->buffer_len > 0) {
+        size_t space = 64u - ctx->buffer_len;
         size_t take = (len < space) ? len : space;
-        memcpy(&sha_ctx.buffer[sha_ctx.buffer_len], &data[offset], take);
-        sha_ctx.buffer_len += take;
+        memcpy(&ctx->buffer[ctx->buffer_len], &data[offset], take);
+        ctx->buffer_len += take;
         offset += take;
         len -= take;
-        if (sha_ctx.buffer_len == 64u) {
-            crypto_sha256_process_block(sha_ctx.buffer);
-            sha_ctx.buffer_len = 0;
+        if (ctx->buffer_len == 64u) {
+            crypto_sha256_process_block(ctx, ctx->buffer);
+            ctx->buffer_len = 0;
         }
     }
 
     while (len >= 64u) {
-        crypto_sha256_process_block(&data[offset]);
+        crypto_sha256_process_block(ctx, &data[offset]);
         offset += 64u;
         len -= 64u;
     }
 
     if (len > 0) {
-        memcpy(sha_ctx.buffer, &data[offset], len);
-        sha_ctx.buffer_len = len;
+        memcpy(ctx->buffer, &data[offset], len);
+        ctx->buffer_len = len;
     }
 }
 
 void
-crypto_sha256_final(uint8_t digest[32])
+crypto_sha256_ctx_final(crypto_sha256_ctx_t *ctx, uint8_t digest[32])
 {
-    uint64_t bit_len = sha_ctx.total_len * 8u;
-    size_t pad_index = sha_ctx.buffer_len;
+    uint64_t bit_len = ctx->total_len * 8u;
+    size_t pad_index = ctx->buffer_len;
 
-    sha_ctx.buffer[pad_index++] = 0x80u;
+    ctx->buffer[pad_index++] = 0x80u;
 
     if (pad_index > 56u) {
         while (pad_index < 64u) {
-            sha_ctx.buffer[pad_index++] = 0;
+            ctx->buffer[pad_index++] = 0;
         }
-        crypto_sha256_process_block(sha_ctx.buffer);
+        crypto_sha256_process_block(ctx, ctx->buffer);
         pad_index = 0;
     }
 
     while (pad_index < 56u) {
-        sha_ctx.buffer[pad_index++] = 0;
+        ctx->buffer[pad_index++] = 0;
     }
 
     for (int i = 7; i >= 0; i--) {
-        sha_ctx.buffer[pad_index++] = (uint8_t)((bit_len >> (i * 8)) & 0xFFu);
+        ctx->buffer[pad_index++] = (uint8_t)((bit_len >> (i * 8)) & 0xFFu);
     }
 
-    crypto_sha256_process_block(sha_ctx.buffer);
+    crypto_sha256_process_block(ctx, ctx->buffer);
 
     for (size_t i = 0; i < 8; i++) {
-        digest[i * 4 + 0] = (uint8_t)(sha_ctx.h[i] >> 24);
-        digest[i * 4 + 1] = (uint8_t)(sha_ctx.h[i] >> 16);
-        digest[i * 4 + 2] = (uint8_t)(sha_ctx.h[i] >> 8);
-        digest[i * 4 + 3] = (uint8_t)(sha_ctx.h[i]);
+        digest[i * 4 + 0] = (uint8_t)(ctx->h[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(ctx->h[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(ctx->h[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)(ctx->h[i]);
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void
+crypto_sha256_init(void)
+{
+    crypto_sha256_ctx_init(&sha_ctx);
+}
+
+void
+crypto_sha256_update(const uint8_t *data, size_t len)
+{
+    crypto_sha256_ctx_update(&sha_ctx, data, len);
+}
+
+void
+crypto_sha256_final(uint8_t digest[32])
+{
+    crypto_sha256_ctx_final(&sha_ctx, digest);
+}
+
+/* -------------------------------------------------------------------------
+ * CRC32
+ * -------------------------------------------------------------------------
+ *
+ * Bitwise implementation of the reflected IEEE 802.3 polynomial.  It is
+ * table-free to keep the bootloader small.  BOOT_FAST builds step a
+ * byte at a time through a 256-entry table that crypto_init() computes
+ * into RAM instead; `bits` is then always a multiple of 8.
+ */
+#ifdef BOOT_FAST
+static uint32_t crc32_table[256];
+
+static ALWAYS_INLINE uint32_t
+crc32_shift(uint32_t crc, int bits)
+{
+    for (int i = 0; i < bits; i += 8) {
+        crc = (crc >> 8) ^ crc32_table[crc & 0xFFu];
+    }
+    return crc;
+}
+#else
+static ALWAYS_INLINE uint32_t
+crc32_shift(uint32_t crc, int bits)
+{
+    for (int i = 0; i < bits; i++) {
+        if (crc & 1) {
+            crc = (crc >> 1) ^ 0xEDB88320UL;
+        } else {
+            crc >>= 1;
+        }
+    }
+    return crc;
+}
+#endif
+
+void
+crypto_init(void)
+{
+#ifdef BOOT_FAST
+    for (uint32_t n = 0; n < 256u; n++) {
+        uint32_t crc = n;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ ((crc & 1u) ? 0xEDB88320UL : 0u);
+        }
+        crc32_table[n] = crc;
+    }
+#endif
+}
+
+static uint32_t
+RAMFUNC(crc32_update)(uint32_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t n = 0; n < len; n++) {
+        crc = crc32_shift(crc ^ data[n], 8);
+    }
+    return crc;
+}
+
+uint32_t
+crypto_crc32_update(uint32_t crc, const uint8_t *data, size_t len)
+{
+    return crc32_update(crc, data, len);
+}
+
+/* -------------------------------------------------------------------------
+ * Fused WRITE data path
+ * -------------------------------------------------------------------------
+ *
+ * Whenever the firmware hash sits on a block boundary and the
+ * destination is word aligned, a whole 64-byte block is handled one
+ * word at a time.  Each word is loaded once from `src` and stored into
+ * `dst`.  The CRC is updated from the register (the reflected CRC
+ * consumes a little-endian word exactly like its four bytes), and the
+ * byte-swapped word goes straight into the SHA-256 message schedule.
+ * Anything else (partial blocks, unaligned destinations) takes the
+ * byte path and goes through the context's block buffer as usual.
+ */
+static uint32_t
+RAMFUNC(crc32_sha256_copy)(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len)
+{
+    while (len > 0u) {
+        if ((sha_ctx.buffer_len == 0u) && (len >= 64u) &&
+            (((uintptr_t)dst & 3u) == 0u)) {
+            uint32_t w[64];
+            uint32_t *out = (uint32_t *)dst;
+            bool aligned = (((uintptr_t)src & 3u) == 0u);
+            for (size_t i = 0; i < 16; i++) {
+                uint32_t v;
+                if (aligned) {
+                    v = ((const uint32_t *)src)[i];
+                } else {
+                    const uint8_t *p = &src[i * 4u];
+                    v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                        ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+                }
+                out[i] = v;
+                crc = crc32_shift(crc ^ v, 32);
+                w[i] = __builtin_bswap32(v);
+            }
+            crypto_sha256_compress(&sha_ctx, w);
+            sha_ctx.total_len += 64u;
+            src += 64u;
+            dst += 64u;
+            len -= 64u;
+            continue;
+        }
+
+        size_t n = 64u - sha_ctx.buffer_len;
+        if (n > len) {
+            n = len;
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint8_t v = src[i];
+            dst[i] = v;
+            crc = crc32_shift(crc ^ v, 8);
+        }
+        crypto_sha256_ctx_update(&sha_ctx, dst, n);
+        src += n;
+        dst += n;
+        len -= n;
     }
+    return crc;
+}
 
-    memset(&sha_ctx, 0, sizeof(sha_ctx));
+uint32_t
+crypto_crc32_sha256_copy(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len)
+{
+    return crc32_sha256_copy(crc, dst, src, len);
 }
 
 /* -------------------------------------------------------------------------
@@ -317,7 +499,10 @@ crypto_sha256_final(uint8_t digest[32])
  * 64-bit intermediate values available on the host system.  The code is
  * optimised for clarity and small footprint rather than throughput, but
  * it is more than adequate for a bootloader that verifies a single
- * signature at boot.
+ * signature at boot.  BOOT_FAST builds spend about 1.8 KiB of flash on
+ * a table of base point multiples and compute S*B - h*A in one joint
+ * windowed pass (ge_double_scalarmult()), roughly halving the field
+ * multiplications per verification.
  */
 
 #include <stddef.h>
@@ -381,14 +566,14 @@ static const uint64_t sha512_k[80] = {
     0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
 };
 
-static inline uint64_t
+static ALWAYS_INLINE uint64_t
 rotr64(uint64_t x, uint8_t n)
 {
     return (x >> n) | (x << (64u - n));
 }
 
 static void
-sha512_process_block(sha512_ctx_t *ctx, const uint8_t block[128])
+RAMFUNC(sha512_process_block)(sha512_ctx_t *ctx, const uint8_t block[128])
 {
     uint64_t w[80];
 
@@ -588,16 +773,21 @@ load64_le(const uint8_t *in)
            ((uint64_t)in[6] << 48) | ((uint64_t)in[7] << 56);
 }
 
+/* Carry the limbs back below 2^51 (v[0] may end a few units above).
+ * The value is only reduced mod p up to a small multiple of p; use
+ * fe51_tobytes() for the canonical form.  Runs from SRAM since every
+ * fe51_mul() ends with it; fe51_sub() and friends call it there. */
 static void
-fe51_reduce(fe51 *r)
+RAMFUNC(fe51_reduce)(fe51 *r)
 {
-    uint64_t c0 = r->v[0] >> 51; r->v[0] &= FE51_MASK; r->v[1] += c0;
-    uint64_t c1 = r->v[1] >> 51; r->v[1] &= FE51_MASK; r->v[2] += c1;
-    uint64_t c2 = r->v[2] >> 51; r->v[2] &= FE51_MASK; r->v[3] += c2;
-    uint64_t c3 = r->v[3] >> 51; r->v[3] &= FE51_MASK; r->v[4] += c3;
-    uint64_t c4 = r->v[4] >> 51; r->v[4] &= FE51_MASK; r->v[0] += c4 * 19ULL;
-    c0 = r->v[0] >> 51; r->v[0] &= FE51_MASK; r->v[1] += c0;
-    r->v[1] &= FE51_MASK;
+    for (int pass = 0; pass < 2; pass++) {
+        uint64_t c;
+        c = r->v[0] >> 51; r->v[0] &= FE51_MASK; r->v[1] += c;
+        c = r->v[1] >> 51; r->v[1] &= FE51_MASK; r->v[2] += c;
+        c = r->v[2] >> 51; r->v[2] &= FE51_MASK; r->v[3] += c;
+        c = r->v[3] >> 51; r->v[3] &= FE51_MASK; r->v[4] += c;
+        c = r->v[4] >> 51; r->v[4] &= FE51_MASK; r->v[0] += c * 19ULL;
+    }
 }
 
 static void
@@ -628,6 +818,21 @@ static void
 fe51_tobytes(uint8_t s[32], fe51 *f)
 {
     fe51_reduce(f);
+
+    /* f < 2p now.  q = 1 exactly when f >= p, i.e. when f + 19 carries
+     * out of bit 255; adding 19q and dropping bit 255 subtracts qp. */
+    uint64_t q = (f->v[0] + 19ULL) >> 51;
+    q = (f->v[1] + q) >> 51;
+    q = (f->v[2] + q) >> 51;
+    q = (f->v[3] + q) >> 51;
+    q = (f->v[4] + q) >> 51;
+    f->v[0] += 19ULL * q;
+    f->v[1] += f->v[0] >> 51; f->v[0] &= FE51_MASK;
+    f->v[2] += f->v[1] >> 51; f->v[1] &= FE51_MASK;
+    f->v[3] += f->v[2] >> 51; f->v[2] &= FE51_MASK;
+    f->v[4] += f->v[3] >> 51; f->v[3] &= FE51_MASK;
+    f->v[4] &= FE51_MASK;
+
     uint64_t t0 = f->v[0] | (f->v[1] << 51);
     uint64_t t1 = (f->v[1] >> 13) | (f->v[2] << 38);
     uint64_t t2 = (f->v[2] >> 26) | (f->v[3] << 25);
@@ -646,15 +851,17 @@ static void fe51_add(fe51 *r, const fe51 *a, const fe51 *b)
     }
 }
 
-static const uint64_t FE51_2P[5] = {
-    4503599627370458ULL, 4503599627370494ULL, 4503599627370494ULL,
-    4503599627370494ULL, 4503599627370494ULL
+/* 4p, added before subtracting so that operands straight out of
+ * fe51_add() (limbs up to about 2^52) cannot underflow. */
+static const uint64_t FE51_4P[5] = {
+    9007199254740916ULL, 9007199254740988ULL, 9007199254740988ULL,
+    9007199254740988ULL, 9007199254740988ULL
 };
 
 static void fe51_sub(fe51 *r, const fe51 *a, const fe51 *b)
 {
     for (int i = 0; i < 5; i++) {
-        r->v[i] = a->v[i] + FE51_2P[i] - b->v[i];
+        r->v[i] = a->v[i] + FE51_4P[i] - b->v[i];
     }
     fe51_reduce(r);
 }
@@ -662,7 +869,7 @@ static void fe51_sub(fe51 *r, const fe51 *a, const fe51 *b)
 static void fe51_neg(fe51 *r, const fe51 *a)
 {
     for (int i = 0; i < 5; i++) {
-        r->v[i] = FE51_2P[i] - a->v[i];
+        r->v[i] = FE51_4P[i] - a->v[i];
     }
     fe51_reduce(r);
 }
@@ -677,7 +884,7 @@ static void UNUSED fe51_cmov(fe51 *r, const fe51 *a, int flag)
     }
 }
 
-static void fe51_mul(fe51 *r, const fe51 *a, const fe51 *b)
+static void RAMFUNC(fe51_mul)(fe51 *r, const fe51 *a, const fe51 *b)
 {
     uint64_t a1_19 = a->v[1] * 19ULL;
     uint64_t a2_19 = a->v[2] * 19ULL;
@@ -741,51 +948,61 @@ static void fe51_pow22523(fe51 *r, const fe51 *z)
     fe51_mul(&t1, &t1, &t2);  /* 31 */
     fe51_sq(&t2, &t1);        /* 62 */
     for (int i = 1; i < 5; i++) fe51_sq(&t2, &t2);
-    fe51_mul(&t1, &t2, &t1);  /* 2^5 - 1 */
+    fe51_mul(&t1, &t2, &t1);  /* 2^10 - 1 */
     fe51_sq(&t2, &t1);
     for (int i = 1; i < 10; i++) fe51_sq(&t2, &t2);
-    fe51_mul(&t2, &t2, &t1);  /* 2^10 - 1 */
+    fe51_mul(&t2, &t2, &t1);  /* 2^20 - 1 */
     fe51_sq(&t0, &t2);
     for (int i = 1; i < 20; i++) fe51_sq(&t0, &t0);
-    fe51_mul(&t2, &t0, &t2);  /* 2^20 - 1 */
+    fe51_mul(&t2, &t0, &t2);  /* 2^40 - 1 */
     fe51_sq(&t2, &t2);
     for (int i = 1; i < 10; i++) fe51_sq(&t2, &t2);
-    fe51_mul(&t1, &t2, &t1);  /* 2^30 - 1 */
+    fe51_mul(&t1, &t2, &t1);  /* 2^50 - 1 */
     fe51_sq(&t2, &t1);
     for (int i = 1; i < 50; i++) fe51_sq(&t2, &t2);
-    fe51_mul(&t2, &t2, &t1);  /* 2^80 - 1 */
+    fe51_mul(&t2, &t2, &t1);  /* 2^100 - 1 */
     fe51_sq(&t0, &t2);
     for (int i = 1; i < 100; i++) fe51_sq(&t0, &t0);
-    fe51_mul(&t2, &t0, &t2);  /* 2^180 - 1 */
+    fe51_mul(&t2, &t0, &t2);  /* 2^200 - 1 */
     fe51_sq(&t2, &t2);
     for (int i = 1; i < 50; i++) fe51_sq(&t2, &t2);
-    fe51_mul(&t1, &t2, &t1);  /* 2^230 - 1 */
+    fe51_mul(&t1, &t2, &t1);  /* 2^250 - 1 */
     fe51_sq(&t1, &t1);
     fe51_sq(&t1, &t1);
-    fe51_mul(r, &t1, &t0);    /* 2^252 - 3 */
+    fe51_mul(r, &t1, z);      /* 2^252 - 3 */
 }
 
+/* r = z^(p - 2) = z^(8 * (2^252 - 3) + 3) */
 static void fe51_invert(fe51 *r, const fe51 *z)
 {
     fe51 t0, t1;
     fe51_pow22523(&t0, z);
-    fe51_sq(&t1, &t0);
-    fe51_sq(&t1, &t1);
-    fe51_mul(r, &t1, z);
+    fe51_sq(&t0, &t0);
+    fe51_sq(&t0, &t0);
+    fe51_sq(&t0, &t0);
+    fe51_sq(&t1, z);
+    fe51_mul(&t1, &t1, z);
+    fe51_mul(r, &t0, &t1);
 }
 
 static int fe51_is_negative(fe51 *a)
 {
-    fe51_reduce(a);
-    return (int)(a->v[0] & 1ULL);
+    uint8_t s[32];
+    fe51_tobytes(s, a);
+    return (int)(s[0] & 1u);
 }
 
 static int fe51_is_nonzero(const fe51 *a)
 {
     fe51 t;
+    uint8_t s[32];
+    uint8_t acc = 0;
     fe51_copy(&t, a);
-    fe51_reduce(&t);
-    return (int)(t.v[0] | t.v[1] | t.v[2] | t.v[3] | t.v[4]);
+    fe51_tobytes(s, &t);
+    for (size_t i = 0; i < sizeof(s); i++) {
+        acc |= s[i];
+    }
+    return acc != 0u;
 }
 
 static const fe51 FE51_CONST_ONE = {{1, 0, 0, 0, 0}};
@@ -806,11 +1023,12 @@ static const fe51 BASEPOINT_Y UNUSED = {{
     900719925474099ULL, 1801439850948198ULL
 }};
 
-static const uint8_t ED25519_BASEPOINT[32] = {
-    0x1a, 0xd5, 0x25, 0x8f, 0x60, 0x2d, 0x56, 0xc9,
-    0xb2, 0xa7, 0x25, 0x95, 0x60, 0xc7, 0x2c, 0x69,
-    0x5c, 0xdc, 0xd6, 0xfd, 0x31, 0xe2, 0xa4, 0xc0,
-    0xfe, 0x53, 0x6e, 0xcd, 0xd3, 0x36, 0x69, 0x21
+/* Encoded base point: y = 4/5 with a positive x. */
+static const uint8_t ED25519_BASEPOINT[32] UNUSED = {
+    0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
 };
 
 typedef struct {
@@ -839,8 +1057,8 @@ static void ge_add(ge_p3 *r, const ge_p3 *p, const ge_p3 *q)
     fe51_add(&Y2plusX2, &q->Y, &q->X);
     fe51_sub(&Y2minusX2, &q->Y, &q->X);
 
-    fe51_mul(&A, &Y1minusX1, &Y2plusX2);
-    fe51_mul(&B, &Y1plusX1, &Y2minusX2);
+    fe51_mul(&A, &Y1minusX1, &Y2minusX2);
+    fe51_mul(&B, &Y1plusX1, &Y2plusX2);
     fe51_mul(&C, &p->T, &q->T);
     fe51_mul(&C, &C, &EDWARDS_D);
     fe51_add(&C, &C, &C);
@@ -902,10 +1120,13 @@ static int ge_frombytes(ge_p3 *p, const uint8_t s[32])
     fe51_mul(&v, &y_sq, &EDWARDS_D);
     fe51_add(&v, &v, &FE51_CONST_ONE);
 
+    /* x = u v^3 (u v^7)^((p - 5) / 8) */
     fe51 v_sq, v_cube, x;
     fe51_sq(&v_sq, &v);
     fe51_mul(&v_cube, &v_sq, &v);
-    fe51_mul(&x, &v_cube, &u);
+    fe51_sq(&x, &v_cube);
+    fe51_mul(&x, &x, &v);
+    fe51_mul(&x, &x, &u);
     fe51_pow22523(&x, &x);
     fe51_mul(&x, &x, &v_cube);
     fe51_mul(&x, &x, &u);
@@ -924,7 +1145,9 @@ static int ge_frombytes(ge_p3 *p, const uint8_t s[32])
         }
     }
 
-    fe51_reduce(&x);
+    if (!fe51_is_nonzero(&x) && sign != 0u) {
+        return -1;
+    }
     if (fe51_is_negative(&x) != (int)sign) {
         fe51_neg(&x, &x);
     }
@@ -951,7 +1174,7 @@ static void ge_tobytes(uint8_t s[32], const ge_p3 *p)
     s[31] ^= (uint8_t)((x_bytes[0] & 1u) << 7);
 }
 
-static void ge_scalarmult(ge_p3 *r, const ge_p3 *p, const uint8_t scalar[32])
+static void UNUSED ge_scalarmult(ge_p3 *r, const ge_p3 *p, const uint8_t scalar[32])
 {
     ge_p3 result;
     ge_identity(&result);
@@ -968,6 +1191,199 @@ static void ge_scalarmult(ge_p3 *r, const ge_p3 *p, const uint8_t scalar[32])
     *r = result;
 }
 
+#ifdef BOOT_FAST
+/* ---- Precomputed base point multiples ------------------------------- */
+
+/* Affine point in the form added by ge_madd(): (y + x, y - x, 2dxy). */
+typedef struct {
+    fe51 yplusx;
+    fe51 yminusx;
+    fe51 xy2d;
+} ge_precomp;
+
+/* n*B for n = 1..15, generated by tools/ed25519_table.py. */
+static const ge_precomp ED25519_BASE_TABLE[15] = {
+    { /* 1*B */
+        {{ 1288382639258501ULL, 245678601348599ULL, 269427782077623ULL,
+           1462984067271730ULL, 137412439391563ULL }},
+        {{ 62697248952638ULL, 204681361388450ULL, 631292143396476ULL,
+           338455783676468ULL, 1213667448819585ULL }},
+        {{ 301289933810280ULL, 1259582250014073ULL, 1422107436869536ULL,
+           796239922652654ULL, 1953934009299142ULL }}
+    },
+    { /* 2*B */
+        {{ 1380971894829527ULL, 790832306631236ULL, 2067202295274102ULL,
+           1995808275510000ULL, 1566530869037010ULL }},
+        {{ 463307831301544ULL, 432984605774163ULL, 1610641361907204ULL,
+           750899048855000ULL, 1894842303421586ULL }},
+        {{ 748439484463711ULL, 1033211726465151ULL, 1396005112841647ULL,
+           1611506220286469ULL, 1972177495910992ULL }}
+    },
+    { /* 3*B */
+        {{ 1601611775252272ULL, 1720807796594148ULL, 1132070835939856ULL,
+           1260455018889551ULL, 2147779492816911ULL }},
+        {{ 316559037616741ULL, 2177824224946892ULL, 1459442586438991ULL,
+           1461528397712656ULL, 751590696113597ULL }},
+        {{ 1850748884277385ULL, 1200145853858453ULL, 1068094770532492ULL,
+           672251375690438ULL, 1586055907191707ULL }}
+    },
+    { /* 4*B */
+        {{ 934282339813791ULL, 1846903124198670ULL, 1172395437954843ULL,
+           1007037127761661ULL, 1830588347719256ULL }},
+        {{ 1694390458783935ULL, 1735906047636159ULL, 705069562067493ULL,
+           648033061693059ULL, 696214010414170ULL }},
+        {{ 1121406372216585ULL, 192876649532226ULL, 190294192191717ULL,
+           1994165897297032ULL, 2245000007398739ULL }}
+    },
+    { /* 5*B */
+        {{ 769950342298419ULL, 132954430919746ULL, 844085933195555ULL,
+           974092374476333ULL, 726076285546016ULL }},
+        {{ 425251763115706ULL, 608463272472562ULL, 442562545713235ULL,
+           837766094556764ULL, 374555092627893ULL }},
+        {{ 1086255230780037ULL, 274979815921559ULL, 1960002765731872ULL,
+           929474102396301ULL, 1190409889297339ULL }}
+    },
+    { /* 6*B */
+        {{ 1388594989461809ULL, 316767091099457ULL, 394298842192982ULL,
+           1230079486801005ULL, 1440737038838979ULL }},
+        {{ 7380825640100ULL, 146210432690483ULL, 304903576448906ULL,
+           1198869323871120ULL, 997689833219095ULL }},
+        {{ 1181317918772081ULL, 114573476638901ULL, 262805072233344ULL,
+           265712217171332ULL, 294181933805782ULL }}
+    },
+    { /* 7*B */
+        {{ 665000864555967ULL, 2065379846933859ULL, 370231110385876ULL,
+           350988370788628ULL, 1233371373142985ULL }},
+        {{ 2019367628972465ULL, 676711900706637ULL, 110710997811333ULL,
+           1108646842542025ULL, 517791959672113ULL }},
+        {{ 965130719900578ULL, 247011430587952ULL, 526356006571389ULL,
+           91986625355052ULL, 2157223321444601ULL }}
+    },
+    { /* 8*B */
+        {{ 2068619540119183ULL, 1966274918058806ULL, 957728544705549ULL,
+           729906502578991ULL, 159834893065166ULL }},
+        {{ 2073601412052185ULL, 31021124762708ULL, 264500969797082ULL,
+           248034690651703ULL, 1030252227928288ULL }},
+        {{ 551790716293402ULL, 1989538725166328ULL, 801169423371717ULL,
+           2052451893578887ULL, 678432056995012ULL }}
+    },
+    { /* 9*B */
+        {{ 1802695059465007ULL, 1664899123557221ULL, 593559490740857ULL,
+           2160434469266659ULL, 927570450755031ULL }},
+        {{ 1725674970513508ULL, 1933645953859181ULL, 1542344539275782ULL,
+           1767788773573747ULL, 1297447965928905ULL }},
+        {{ 1381809363726107ULL, 1430341051343062ULL, 2061843536018959ULL,
+           1551778050872521ULL, 2036394857967624ULL }}
+    },
+    { /* 10*B */
+        {{ 1569908045411470ULL, 706723917266915ULL, 1500941167088851ULL,
+           271058246676941ULL, 1190527933001305ULL }},
+        {{ 938493881647581ULL, 1913928661987006ULL, 2094455298711648ULL,
+           986546367603450ULL, 58515486184715ULL }},
+        {{ 1454533688490200ULL, 416156769327623ULL, 1344514353803379ULL,
+           1816391251363763ULL, 259908591619060ULL }}
+    },
+    { /* 11*B */
+        {{ 1970894096313054ULL, 528066325833207ULL, 1619374932191227ULL,
+           2207306624415883ULL, 1169170329061080ULL }},
+        {{ 2070390218572616ULL, 1458919061857835ULL, 624171843017421ULL,
+           1055332792707765ULL, 433987520732508ULL }},
+        {{ 893653801273833ULL, 1168026499324677ULL, 1242553501121234ULL,
+           1306366254304474ULL, 1086752658510815ULL }}
+    },
+    { /* 12*B */
+        {{ 1548398643541305ULL, 838955728976966ULL, 116266075650295ULL,
+           1878116023572280ULL, 132675799667661ULL }},
+        {{ 2114866412082361ULL, 591083254091949ULL, 940561138633470ULL,
+           412059816539947ULL, 2134627974686210ULL }},
+        {{ 1571032457823571ULL, 1253760059932116ULL, 665829584253800ULL,
+           109400965270906ULL, 981221002823741ULL }}
+    },
+    { /* 13*B */
+        {{ 213454002618221ULL, 939771523987438ULL, 1159882208056014ULL,
+           317388369627517ULL, 621213314200687ULL }},
+        {{ 1971678598905747ULL, 338026507889165ULL, 762398079972271ULL,
+           655096486107477ULL, 42299032696322ULL }},
+        {{ 177130678690680ULL, 1754759263300204ULL, 1864311296286618ULL,
+           1180675631479880ULL, 1292726903152791ULL }}
+    },
+    { /* 14*B */
+        {{ 124159973735922ULL, 12085856625887ULL, 570609322991103ULL,
+           870869641855508ULL, 1947192330052817ULL }},
+        {{ 996453150823040ULL, 557931626380283ULL, 1039170142840520ULL,
+           115485616863415ULL, 808203906823112ULL }},
+        {{ 498660636760962ULL, 1605652986893012ULL, 893278769679967ULL,
+           1769999239723039ULL, 646478004325289ULL }}
+    },
+    { /* 15*B */
+        {{ 1913163449625248ULL, 460779200291993ULL, 2193883288642314ULL,
+           1008900146920800ULL, 1721983679009502ULL }},
+        {{ 1070401523076875ULL, 1272492007800961ULL, 1910153608563310ULL,
+           2075579521696771ULL, 1191169788841221ULL }},
+        {{ 692896803108118ULL, 500174642072499ULL, 2068223309439677ULL,
+           1162190621851337ULL, 1426986007309901ULL }}
+    }
+};
+
+/* r = p + q for an affine precomputed q (Z2 = 1, T2 folded into xy2d). */
+static void ge_madd(ge_p3 *r, const ge_p3 *p, const ge_precomp *q)
+{
+    fe51 Y1plusX1, Y1minusX1;
+    fe51 A, B, C, D, E, F, G, H;
+
+    fe51_add(&Y1plusX1, &p->Y, &p->X);
+    fe51_sub(&Y1minusX1, &p->Y, &p->X);
+
+    fe51_mul(&A, &Y1minusX1, &q->yminusx);
+    fe51_mul(&B, &Y1plusX1, &q->yplusx);
+    fe51_mul(&C, &p->T, &q->xy2d);
+    fe51_add(&D, &p->Z, &p->Z);
+
+    fe51_sub(&E, &B, &A);
+    fe51_sub(&F, &D, &C);
+    fe51_add(&G, &D, &C);
+    fe51_add(&H, &B, &A);
+
+    fe51_mul(&r->X, &E, &F);
+    fe51_mul(&r->Y, &G, &H);
+    fe51_mul(&r->Z, &F, &G);
+    fe51_mul(&r->T, &E, &H);
+}
+
+/* r = a*A + b*B with both scalars scanned together in 4-bit windows
+ * (Straus): 252 doublings shared by the two products, plus at most one
+ * addition from the runtime table of A and one mixed addition from
+ * ED25519_BASE_TABLE per window. */
+static void ge_double_scalarmult(ge_p3 *r, const uint8_t a[32],
+                                 const ge_p3 *A, const uint8_t b[32])
+{
+    ge_p3 Ai[15];
+    Ai[0] = *A;
+    for (int n = 1; n < 15; n++) {
+        ge_add(&Ai[n], &Ai[n - 1], A);
+    }
+
+    ge_identity(r);
+    for (int i = 63; i >= 0; i--) {
+        if (i != 63) {
+            ge_double(r, r);
+            ge_double(r, r);
+            ge_double(r, r);
+            ge_double(r, r);
+        }
+        unsigned shift = (unsigned)(i & 1) * 4u;
+        unsigned na = (a[i >> 1] >> shift) & 0xFu;
+        unsigned nb = (b[i >> 1] >> shift) & 0xFu;
+        if (na != 0u) {
+            ge_add(r, r, &Ai[na - 1u]);
+        }
+        if (nb != 0u) {
+            ge_madd(r, r, &ED25519_BASE_TABLE[nb - 1u]);
+        }
+    }
+}
+#endif /* BOOT_FAST */
+
 /* ---- Scalar arithmetic ----------------------------------------------- */
 
 static uint64_t load_3(const uint8_t *in)
@@ -1055,6 +1471,23 @@ static void sc_reduce(uint8_t s[64])
     s11 -= s18 * 683901;
     s18 = 0;
 
+    int64_t carry0, carry1, carry2, carry3, carry4, carry5;
+    int64_t carry6, carry7, carry8, carry9, carry10, carry11;
+    int64_t carry12, carry13, carry14, carry15, carry16;
+
+    carry6 = (s6 + (1 << 20)) >> 21; s7 += carry6; s6 -= carry6 << 21;
+    carry8 = (s8 + (1 << 20)) >> 21; s9 += carry8; s8 -= carry8 << 21;
+    carry10 = (s10 + (1 << 20)) >> 21; s11 += carry10; s10 -= carry10 << 21;
+    carry12 = (s12 + (1 << 20)) >> 21; s13 += carry12; s12 -= carry12 << 21;
+    carry14 = (s14 + (1 << 20)) >> 21; s15 += carry14; s14 -= carry14 << 21;
+    carry16 = (s16 + (1 << 20)) >> 21; s17 += carry16; s16 -= carry16 << 21;
+
+    carry7 = (s7 + (1 << 20)) >> 21; s8 += carry7; s7 -= carry7 << 21;
+    carry9 = (s9 + (1 << 20)) >> 21; s10 += carry9; s9 -= carry9 << 21;
+    carry11 = (s11 + (1 << 20)) >> 21; s12 += carry11; s11 -= carry11 << 21;
+    carry13 = (s13 + (1 << 20)) >> 21; s14 += carry13; s13 -= carry13 << 21;
+    carry15 = (s15 + (1 << 20)) >> 21; s16 += carry15; s15 -= carry15 << 21;
+
     s5 += s17 * 666643;
     s6 += s17 * 470296;
     s7 += s17 * 654183;
@@ -1103,18 +1536,19 @@ static void sc_reduce(uint8_t s[64])
     s5 -= s12 * 683901;
     s12 = 0;
 
-    int64_t carry0 = (s0 + (1 << 20)) >> 21; s1 += carry0; s0 -= carry0 << 21;
-    int64_t carry1 = (s1 + (1 << 20)) >> 21; s2 += carry1; s1 -= carry1 << 21;
-    int64_t carry2 = (s2 + (1 << 20)) >> 21; s3 += carry2; s2 -= carry2 << 21;
-    int64_t carry3 = (s3 + (1 << 20)) >> 21; s4 += carry3; s3 -= carry3 << 21;
-    int64_t carry4 = (s4 + (1 << 20)) >> 21; s5 += carry4; s4 -= carry4 << 21;
-    int64_t carry5 = (s5 + (1 << 20)) >> 21; s6 += carry5; s5 -= carry5 << 21;
-    int64_t carry6 = (s6 + (1 << 20)) >> 21; s7 += carry6; s6 -= carry6 << 21;
-    int64_t carry7 = (s7 + (1 << 20)) >> 21; s8 += carry7; s7 -= carry7 << 21;
-    int64_t carry8 = (s8 + (1 << 20)) >> 21; s9 += carry8; s8 -= carry8 << 21;
-    int64_t carry9 = (s9 + (1 << 20)) >> 21; s10 += carry9; s9 -= carry9 << 21;
-    int64_t carry10 = (s10 + (1 << 20)) >> 21; s11 += carry10; s10 -= carry10 << 21;
-    int64_t carry11 = (s11 + (1 << 20)) >> 21; s12 += carry11; s11 -= carry11 << 21;
+    carry0 = (s0 + (1 << 20)) >> 21; s1 += carry0; s0 -= carry0 << 21;
+    carry2 = (s2 + (1 << 20)) >> 21; s3 += carry2; s2 -= carry2 << 21;
+    carry4 = (s4 + (1 << 20)) >> 21; s5 += carry4; s4 -= carry4 << 21;
+    carry6 = (s6 + (1 << 20)) >> 21; s7 += carry6; s6 -= carry6 << 21;
+    carry8 = (s8 + (1 << 20)) >> 21; s9 += carry8; s8 -= carry8 << 21;
+    carry10 = (s10 + (1 << 20)) >> 21; s11 += carry10; s10 -= carry10 << 21;
+
+    carry1 = (s1 + (1 << 20)) >> 21; s2 += carry1; s1 -= carry1 << 21;
+    carry3 = (s3 + (1 << 20)) >> 21; s4 += carry3; s3 -= carry3 << 21;
+    carry5 = (s5 + (1 << 20)) >> 21; s6 += carry5; s5 -= carry5 << 21;
+    carry7 = (s7 + (1 << 20)) >> 21; s8 += carry7; s7 -= carry7 << 21;
+    carry9 = (s9 + (1 << 20)) >> 21; s10 += carry9; s9 -= carry9 << 21;
+    carry11 = (s11 + (1 << 20)) >> 21; s12 += carry11; s11 -= carry11 << 21;
 
     s0 += s12 * 666643;
     s1 += s12 * 470296;
@@ -1124,17 +1558,39 @@ static void sc_reduce(uint8_t s[64])
     s5 -= s12 * 683901;
     s12 = 0;
 
-    carry0 = (s0 + (1 << 20)) >> 21; s1 += carry0; s0 -= carry0 << 21;
-    carry1 = (s1 + (1 << 20)) >> 21; s2 += carry1; s1 -= carry1 << 21;
-    carry2 = (s2 + (1 << 20)) >> 21; s3 += carry2; s2 -= carry2 << 21;
-    carry3 = (s3 + (1 << 20)) >> 21; s4 += carry3; s3 -= carry3 << 21;
-    carry4 = (s4 + (1 << 20)) >> 21; s5 += carry4; s4 -= carry4 << 21;
-    carry5 = (s5 + (1 << 20)) >> 21; s6 += carry5; s5 -= carry5 << 21;
-    carry6 = (s6 + (1 << 20)) >> 21; s7 += carry6; s6 -= carry6 << 21;
-    carry7 = (s7 + (1 << 20)) >> 21; s8 += carry7; s7 -= carry7 << 21;
-    carry8 = (s8 + (1 << 20)) >> 21; s9 += carry8; s8 -= carry8 << 21;
-    carry9 = (s9 + (1 << 20)) >> 21; s10 += carry9; s9 -= carry9 << 21;
-    carry10 = (s10 + (1 << 20)) >> 21; s11 += carry10; s10 -= carry10 << 21;
+    /* Floor carries from here on, so every limb ends up non-negative. */
+    carry0 = s0 >> 21; s1 += carry0; s0 -= carry0 << 21;
+    carry1 = s1 >> 21; s2 += carry1; s1 -= carry1 << 21;
+    carry2 = s2 >> 21; s3 += carry2; s2 -= carry2 << 21;
+    carry3 = s3 >> 21; s4 += carry3; s3 -= carry3 << 21;
+    carry4 = s4 >> 21; s5 += carry4; s4 -= carry4 << 21;
+    carry5 = s5 >> 21; s6 += carry5; s5 -= carry5 << 21;
+    carry6 = s6 >> 21; s7 += carry6; s6 -= carry6 << 21;
+    carry7 = s7 >> 21; s8 += carry7; s7 -= carry7 << 21;
+    carry8 = s8 >> 21; s9 += carry8; s8 -= carry8 << 21;
+    carry9 = s9 >> 21; s10 += carry9; s9 -= carry9 << 21;
+    carry10 = s10 >> 21; s11 += carry10; s10 -= carry10 << 21;
+    carry11 = s11 >> 21; s12 += carry11; s11 -= carry11 << 21;
+
+    s0 += s12 * 666643;
+    s1 += s12 * 470296;
+    s2 += s12 * 654183;
+    s3 -= s12 * 997805;
+    s4 += s12 * 136657;
+    s5 -= s12 * 683901;
+    s12 = 0;
+
+    carry0 = s0 >> 21; s1 += carry0; s0 -= carry0 << 21;
+    carry1 = s1 >> 21; s2 += carry1; s1 -= carry1 << 21;
+    carry2 = s2 >> 21; s3 += carry2; s2 -= carry2 << 21;
+    carry3 = s3 >> 21; s4 += carry3; s3 -= carry3 << 21;
+    carry4 = s4 >> 21; s5 += carry4; s4 -= carry4 << 21;
+    carry5 = s5 >> 21; s6 += carry5; s5 -= carry5 << 21;
+    carry6 = s6 >> 21; s7 += carry6; s6 -= carry6 << 21;
+    carry7 = s7 >> 21; s8 += carry7; s7 -= carry7 << 21;
+    carry8 = s8 >> 21; s9 += carry8; s8 -= carry8 << 21;
+    carry9 = s9 >> 21; s10 += carry9; s9 -= carry9 << 21;
+    carry10 = s10 >> 21; s11 += carry10; s10 -= carry10 << 21;
 
     s[0] = (uint8_t)(s0 >> 0);
     s[1] = (uint8_t)(s0 >> 8);
@@ -1177,19 +1633,16 @@ static const uint8_t SC_L[32] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
 };
 
+/* Return nonzero unless s < L; RFC 8032 rejects S >= L, including
+ * S == L itself. */
 static int sc_check(const uint8_t s[32])
 {
-    uint8_t c = 0;
-    int gt = 0;
     for (int i = 31; i >= 0; i--) {
-        if (s[i] > SC_L[i] && c == 0) {
-            gt = 1;
-        }
-        if (s[i] < SC_L[i]) {
-            c = 1;
+        if (s[i] != SC_L[i]) {
+            return s[i] > SC_L[i];
         }
     }
-    return gt;
+    return 1;
 }
 
 /* ---- Ed25519 verification -------------------------------------------- */
@@ -1206,15 +1659,22 @@ crypto_ed25519_verify(const uint8_t signature[64], const uint8_t hash[32])
         return false;
     }
 
+    uint8_t hram[64];
+    sha512_three(signature, 32, ZK_PUBKEY, 32, hash, 32, hram);
+    sc_reduce(hram);
+
+    ge_p3 Rcalc;
+#ifdef BOOT_FAST
+    /* R = S*B + h*(-A) */
+    fe51_neg(&A.X, &A.X);
+    fe51_neg(&A.T, &A.T);
+    ge_double_scalarmult(&Rcalc, hram, &A, signature + 32);
+#else
     ge_p3 B;
     if (ge_frombytes(&B, ED25519_BASEPOINT) != 0) {
         return false;
     }
 
-    uint8_t hram[64];
-    sha512_three(signature, 32, ZK_PUBKEY, 32, hash, 32, hram);
-    sc_reduce(hram);
-
     ge_p3 SB, hA;
     ge_scalarmult(&SB, &B, signature + 32);
     ge_scalarmult(&hA, &A, hram);
@@ -1222,8 +1682,8 @@ crypto_ed25519_verify(const uint8_t signature[64], const uint8_t hash[32])
     fe51_neg(&hA.X, &hA.X);
     fe51_neg(&hA.T, &hA.T);
 
-    ge_p3 Rcalc;
     ge_add(&Rcalc, &SB, &hA);
+#endif
 
     uint8_t rcheck[32];
     ge_tobytes(rcheck, &Rcalc);
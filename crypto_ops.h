@@ -33,6 +33,25 @@ static const uint8_t ZK_PUBKEY[32] = {
     0xD2, 0xD3, 0xE6, 0x7F, 0x62, 0x80, 0x49, 0x7B
 };
 
+/* Set up the lookup tables of BOOT_FAST builds (a no-op otherwise).
+ * Must run once at start-up before any CRC is computed. */
+void crypto_init(void);
+
+/* SHA‑256 hashing state.  The crypto_sha256_ctx_* functions operate on
+ * a caller-owned context so independent hashes can run side by side;
+ * the context-free functions below use a single internal context that
+ * tracks the firmware image being received. */
+typedef struct {
+    uint32_t h[8];
+    uint8_t  buffer[64];
+    size_t   buffer_len;
+    uint64_t total_len;
+} crypto_sha256_ctx_t;
+
+void crypto_sha256_ctx_init(crypto_sha256_ctx_t *ctx);
+void crypto_sha256_ctx_update(crypto_sha256_ctx_t *ctx, const uint8_t *data, size_t len);
+void crypto_sha256_ctx_final(crypto_sha256_ctx_t *ctx, uint8_t digest[32]);
+
 /* Initialise the SHA‑256 hash context.  Must be called before
  * updating the hash with firmware bytes.  In a real implementation
  * this would set up the state variables (h0–h7) defined in the
@@ -58,4 +77,16 @@ void crypto_sha256_final(uint8_t digest[32]);
  * uses this to authenticate firmware before jumping to it. */
 bool crypto_ed25519_verify(const uint8_t signature[64], const uint8_t hash[32]);
 
+/* Update a CRC32 (IEEE 802.3, reflected polynomial 0xEDB88320) with
+ * `len` bytes.  Start from 0xFFFFFFFF and XOR the final value with
+ * 0xFFFFFFFF, as used for WRITE block checks. */
+uint32_t crypto_crc32_update(uint32_t crc, const uint8_t *data, size_t len);
+
+/* Fused kernel for the WRITE data path: copy `len` bytes from `src` to
+ * `dst` while updating `crc` (as crypto_crc32_update) and the internal
+ * firmware SHA‑256 (as crypto_sha256_update).  Each source word is read
+ * once; whole 64-byte blocks go straight into the SHA‑256 message
+ * schedule.  Returns the updated CRC. */
+uint32_t crypto_crc32_sha256_copy(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+
 #endif /* CRYPTO_OPS_H */
\ No newline at end of file
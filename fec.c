@@ -0,0 +1,314 @@
+/*
+ * fec.c - Reed–Solomon forward error correction for the host link
+ *
+ * Classic syndrome decoder: syndromes by Horner evaluation, the error
+ * locator by Berlekamp–Massey, error positions by Chien search and
+ * magnitudes by Forney's formula.  The log/antilog tables are computed
+ * into RAM at start-up rather than stored in flash.
+ */
+
+#include "fec.h"
+#include "protocol.h"
+#include "crypto_ops.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* External functions provided by the USB layer */
+extern void usb_cdc_write(const uint8_t *data, size_t len);
+
+#define GF_POLY 0x11Du
+
+static uint8_t gf_exp[512];
+static uint8_t gf_log[256];
+
+static const uint8_t fec_sync[FEC_SYNC_SIZE] = FEC_SYNC_WORD;
+
+static bool        fec_on;
+static uint8_t     frame[FEC_CODEWORD_SIZE];
+static size_t      frame_index;
+static size_t      sync_matched; /* sync bytes seen; a frame follows
+                                  * once all FEC_SYNC_SIZE matched   */
+static bool        loss_reported; /* ERR FEC already sent for the data
+                                   * lost since the last good frame  */
+static fec_stats_t stats;
+
+static uint8_t
+gf_mul(uint8_t a, uint8_t b)
+{
+    if (a == 0u || b == 0u) {
+        return 0u;
+    }
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static uint8_t
+gf_div(uint8_t a, uint8_t b)
+{
+    if (a == 0u) {
+        return 0u;
+    }
+    return gf_exp[gf_log[a] + 255u - gf_log[b]];
+}
+
+/* Evaluate poly[0] + poly[1] x + ... + poly[deg] x^deg at x. */
+static uint8_t
+gf_poly_eval(const uint8_t *poly, size_t deg, uint8_t x)
+{
+    uint8_t y = poly[deg];
+    for (size_t i = deg; i-- > 0;) {
+        y = gf_mul(y, x) ^ poly[i];
+    }
+    return y;
+}
+
+/* Find the corrections for `frame` without applying them: byte
+ * err_pos[k] is off by err_val[k].  Returns the number of corrections,
+ * or -1 when the codeword has more errors than the code can handle. */
+static int
+rs_decode(uint8_t *err_pos, uint8_t *err_val)
+{
+    uint8_t synd[FEC_PARITY_SIZE];
+    bool clean = true;
+
+    for (size_t j = 0; j < FEC_PARITY_SIZE; j++) {
+        uint8_t root = gf_exp[j];
+        uint8_t s = 0;
+        for (size_t i = 0; i < FEC_CODEWORD_SIZE; i++) {
+            s = gf_mul(s, root) ^ frame[i];
+        }
+        synd[j] = s;
+        if (s != 0u) {
+            clean = false;
+        }
+    }
+    if (clean) {
+        return 0;
+    }
+
+    /* Berlekamp–Massey: find the error locator polynomial lambda. */
+    uint8_t lambda[FEC_PARITY_SIZE + 1] = { 1 };
+    uint8_t prev[FEC_PARITY_SIZE + 1] = { 1 };
+    uint8_t tmp[FEC_PARITY_SIZE + 1];
+    size_t  errs = 0;
+    size_t  shift = 1;
+    uint8_t prev_disc = 1;
+
+    for (size_t r = 0; r < FEC_PARITY_SIZE; r++) {
+        uint8_t disc = synd[r];
+        for (size_t i = 1; i <= errs; i++) {
+            disc ^= gf_mul(lambda[i], synd[r - i]);
+        }
+        if (disc == 0u) {
+            shift++;
+            continue;
+        }
+        uint8_t coef = gf_div(disc, prev_disc);
+        memcpy(tmp, lambda, sizeof(tmp));
+        for (size_t i = 0; (i + shift) <= FEC_PARITY_SIZE; i++) {
+            lambda[i + shift] ^= gf_mul(coef, prev[i]);
+        }
+        if ((2u * errs) <= r) {
+            errs = r + 1u - errs;
+            memcpy(prev, tmp, sizeof(prev));
+            prev_disc = disc;
+            shift = 1;
+        } else {
+            shift++;
+        }
+    }
+    if (errs > (FEC_PARITY_SIZE / 2u)) {
+        return -1;
+    }
+
+    /* omega = synd * lambda mod x^FEC_PARITY_SIZE (error evaluator). */
+    uint8_t omega[FEC_PARITY_SIZE];
+    for (size_t i = 0; i < FEC_PARITY_SIZE; i++) {
+        uint8_t v = 0;
+        for (size_t k = 0; k <= i && k <= errs; k++) {
+            v ^= gf_mul(lambda[k], synd[i - k]);
+        }
+        omega[i] = v;
+    }
+
+    /* Chien search and Forney.  Byte i holds the coefficient of
+     * x^(254 - i), so its locator is X = alpha^(254 - i).  The locator
+     * is only trusted if every one of its roots is found. */
+    size_t found = 0;
+    for (size_t i = 0; i < FEC_CODEWORD_SIZE; i++) {
+        size_t power = FEC_CODEWORD_SIZE - 1u - i;
+        uint8_t x_inv = gf_exp[(255u - power) % 255u];
+        if (gf_poly_eval(lambda, errs, x_inv) != 0u) {
+            continue;
+        }
+        /* Formal derivative: only odd-degree terms survive. */
+        uint8_t deriv = 0;
+        for (size_t k = 1; k <= errs; k += 2u) {
+            uint8_t term = lambda[k];
+            for (size_t p = 1; p < k; p++) {
+                term = gf_mul(term, x_inv);
+            }
+            deriv ^= term;
+        }
+        if (deriv == 0u || found == errs) {
+            return -1;
+        }
+        uint8_t num = gf_mul(gf_exp[power],
+                             gf_poly_eval(omega, FEC_PARITY_SIZE - 1u, x_inv));
+        err_pos[found] = (uint8_t)i;
+        err_val[found] = gf_div(num, deriv);
+        found++;
+    }
+    if (found != errs) {
+        return -1;
+    }
+    return (int)found;
+}
+
+void
+fec_init(void)
+{
+    uint16_t x = 1;
+    for (size_t i = 0; i < 255u; i++) {
+        gf_exp[i] = (uint8_t)x;
+        gf_log[x] = (uint8_t)i;
+        x <<= 1;
+        if ((x & 0x100u) != 0u) {
+            x ^= GF_POLY;
+        }
+    }
+    for (size_t i = 255u; i < sizeof(gf_exp); i++) {
+        gf_exp[i] = gf_exp[i - 255u];
+    }
+    fec_on = false;
+    frame_index = 0;
+}
+
+void
+fec_enable(bool enable)
+{
+    fec_on = enable;
+    frame_index = 0;
+    sync_matched = 0;
+    loss_reported = false;
+    if (enable) {
+        memset(&stats, 0, sizeof(stats));
+    }
+}
+
+/* Tell the host once that data since the last good frame was lost. */
+static void
+fec_report_loss(void)
+{
+    if (!loss_reported) {
+        loss_reported = true;
+        stats.failed_frames++;
+        usb_cdc_write((const uint8_t *)"ERR FEC\n", 8);
+    }
+}
+
+/* Advance the sync word search by one byte.  Anything but the next
+ * sync byte means host data is being thrown away.  The sync word has
+ * no prefix that is also its suffix, so a mismatch can only restart
+ * the search at this byte. */
+static void
+fec_hunt(uint8_t c)
+{
+    if (c == fec_sync[sync_matched]) {
+        sync_matched++;
+        return;
+    }
+    fec_report_loss();
+    sync_matched = (c == fec_sync[0]) ? 1u : 0u;
+}
+
+/* Check the length byte and the CRC32 over the data bytes that
+ * precede it.  Reed–Solomon codes are cyclic: a frame that slipped by a
+ * few bytes is close to a rotated codeword and can decode, but its CRC
+ * will not match. */
+static bool
+fec_frame_crc_ok(void)
+{
+    const uint8_t *stored = &frame[FEC_CRC_OFFSET];
+    uint32_t crc = crypto_crc32_update(0xFFFFFFFFUL, frame, FEC_CRC_OFFSET) ^
+                   0xFFFFFFFFUL;
+    uint32_t want = (uint32_t)stored[0] | ((uint32_t)stored[1] << 8) |
+                    ((uint32_t)stored[2] << 16) | ((uint32_t)stored[3] << 24);
+    return (crc == want) && (frame[0] <= FEC_MAX_PAYLOAD);
+}
+
+static void
+fec_apply(const uint8_t *err_pos, const uint8_t *err_val, int count)
+{
+    for (int k = 0; k < count; k++) {
+        frame[err_pos[k]] ^= err_val[k];
+    }
+}
+
+/* Decode a complete codeword and deliver its payload. */
+static void
+fec_frame_done(void)
+{
+    uint8_t err_pos[FEC_PARITY_SIZE / 2u];
+    uint8_t err_val[FEC_PARITY_SIZE / 2u];
+
+    frame_index = 0;
+    sync_matched = 0;
+    stats.frames++;
+
+    int fixed = rs_decode(err_pos, err_val);
+    if (fixed > 0) {
+        fec_apply(err_pos, err_val, fixed);
+    }
+    if (fixed < 0 || !fec_frame_crc_ok()) {
+        /* Rescan the bytes as received, not as "corrected" */
+        if (fixed > 0) {
+            fec_apply(err_pos, err_val, fixed);
+        }
+        fec_report_loss();
+        /* A slipped or inserted byte makes the frame swallow the start
+         * of the next sync word; search the rejected bytes for it.
+         * Bytes after a sync word are copied down to the frame start,
+         * always behind the read position, and fewer than a whole
+         * codeword remain, so this cannot recurse. */
+        for (size_t i = 1; i < FEC_CODEWORD_SIZE; i++) {
+            fec_process_char(frame[i]);
+        }
+        return;
+    }
+    stats.corrected_bytes += (uint32_t)fixed;
+    loss_reported = false;
+
+    /* The payload may itself contain FEC OFF; the remaining bytes of
+     * this frame are still delivered in order. */
+    size_t used = 0;
+    while (used < frame[0]) {
+        used += protocol_process(&frame[1u + used], frame[0] - used);
+        protocol_dispatch();
+    }
+}
+
+void
+fec_process_char(uint8_t c)
+{
+    if (!fec_on) {
+        protocol_process_char(c);
+        return;
+    }
+
+    if (sync_matched < FEC_SYNC_SIZE) {
+        fec_hunt(c);
+        return;
+    }
+    frame[frame_index++] = c;
+    if (frame_index == FEC_CODEWORD_SIZE) {
+        fec_frame_done();
+    }
+}
+
+const fec_stats_t *
+fec_get_stats(void)
+{
+    return &stats;
+}
@@ -0,0 +1,70 @@
+/*
+ * fec.h - Reed–Solomon forward error correction for the host link
+ *
+ * Optional layer built when BOOT_FEC is defined (`make FEC=1`).  It
+ * sits between the byte transport and the protocol parser.  Once the
+ * host sends `FEC ON`, every byte from the host is part of a frame: a
+ * four-byte sync word followed by a 255-byte RS(255,223) codeword over
+ * GF(2^8) (polynomial 0x11D, generator roots alpha^0 .. alpha^31).  Up
+ * to 16 corrupted bytes per codeword are repaired in place, so a noisy
+ * link does not cost a block resend.
+ *
+ * Frame layout (byte 0 is sent first):
+ *   [0..3]     sync word 1A CF FC 1D
+ *   [4]        payload length L (0..218)
+ *   [5..L+4]   payload bytes, passed to the protocol parser in order
+ *   [L+5..222] zero padding
+ *   [223..226] CRC32 (IEEE 802.3, little endian) of bytes 4..222
+ *   [227..258] parity
+ *
+ * A codeword carries 218 payload bytes, slightly less than one flash
+ * row, so a frame fits in a row-sized staging buffer.  Replies from the
+ * bootloader are not encoded.  The sync word is not covered by the
+ * code; after a dropped or inserted byte the decoder searches for it
+ * again, starting inside the rejected frame, so only the frames
+ * touched by the slip are lost.  The code is cyclic, so a frame that
+ * slipped near its start can "correct" into a rotated codeword; the
+ * CRC rejects those.  A frame that cannot be corrected or fails the
+ * CRC, or bytes skipped while searching for a sync word, are answered
+ * with one `ERR FEC` until a frame decodes again.  tools/rs_fec.py
+ * builds the frames.
+ */
+
+#ifndef FEC_H
+#define FEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FEC_CODEWORD_SIZE 255u
+#define FEC_PARITY_SIZE   32u
+#define FEC_DATA_SIZE     (FEC_CODEWORD_SIZE - FEC_PARITY_SIZE)
+#define FEC_CRC_OFFSET    (FEC_DATA_SIZE - 4u)
+#define FEC_MAX_PAYLOAD   (FEC_CRC_OFFSET - 1u)
+
+/* Sync word sent before every codeword (the CCSDS attached sync marker) */
+#define FEC_SYNC_SIZE     4u
+#define FEC_SYNC_WORD     { 0x1Au, 0xCFu, 0xFCu, 0x1Du }
+
+/* Error-correction counters reported by the STATS command. */
+typedef struct {
+    uint32_t frames;          /* codewords received                  */
+    uint32_t corrected_bytes; /* bytes repaired across all codewords */
+    uint32_t failed_frames;   /* ERR FEC replies: codewords lost     */
+} fec_stats_t;
+
+/* Build the GF(2^8) tables and start with FEC disabled. */
+void fec_init(void);
+
+/* Switch codeword framing on or off.  Enabling discards any partial
+ * frame, waits for a sync word and resets the counters. */
+void fec_enable(bool enable);
+
+/* Feed one byte from the transport.  While FEC is disabled the byte is
+ * passed straight to protocol_process_char(). */
+void fec_process_char(uint8_t c);
+
+/* Return the counters accumulated since FEC was last enabled. */
+const fec_stats_t *fec_get_stats(void);
+
+#endif /* FEC_H */
@@ -107,6 +107,23 @@ flash_erase_range(uint32_t addr, size_t len)
     }
 }
 
+/* Program a single page from word-aligned data: clear the NVM page
+ * buffer, fill it with 32-bit writes, then commit it with WP. */
+static void
+flash_program_page(uint32_t addr, const uint32_t *words)
+{
+    nvm_wait_ready();
+    nvm_exec_cmd(NVMCTRL_CTRLA_CMD_PBC);
+
+    volatile uint32_t *dest = (volatile uint32_t *)addr;
+    for (size_t i = 0; i < (FLASH_PAGE_SIZE / sizeof(uint32_t)); ++i) {
+        dest[i] = words[i];
+    }
+
+    NVMCTRL_ADDR_REG = addr / 2U;
+    nvm_exec_cmd(NVMCTRL_CTRLA_CMD_WP);
+}
+
 /* Program one or more flash pages.  Each page is staged via the NVM page
  * buffer, written as 32-bit words, then committed with the WP command. */
 void
@@ -124,17 +141,7 @@ flash_write(uint32_t addr, const uint8_t *data, size_t len)
         memset(page_buffer.b, 0xFF, sizeof(page_buffer.b));
         memcpy(page_buffer.b, data, chunk);
 
-        nvm_wait_ready();
-        nvm_exec_cmd(NVMCTRL_CTRLA_CMD_PBC);
-
-        volatile uint32_t *dest = (volatile uint32_t *)addr;
-        const uint32_t *src = page_buffer.w;
-        for (size_t i = 0; i < (FLASH_PAGE_SIZE / sizeof(uint32_t)); ++i) {
-            dest[i] = src[i];
-        }
-
-        NVMCTRL_ADDR_REG = addr / 2U;
-        nvm_exec_cmd(NVMCTRL_CTRLA_CMD_WP);
+        flash_program_page(addr, page_buffer.w);
 
         addr += FLASH_PAGE_SIZE;
         data += chunk;
@@ -142,14 +149,101 @@ flash_write(uint32_t addr, const uint8_t *data, size_t len)
     }
 }
 
-/* Write APP_VALID_MAGIC into the word preceding the application start
- * address.  This flag is used by main.c to decide whether a valid
- * application exists.  The row containing this word must have been
- * erased already. */
+/* Write-combining row cache ------------------------------------------------
+ *
+ * Holds at most one row.  Bytes the host has not supplied stay 0xFF,
+ * which leaves erased flash untouched when the page is programmed, and
+ * only pages that received data are written when the row is flushed.
+ */
+static struct {
+    union {
+        uint8_t b[FLASH_ROW_SIZE];
+        uint32_t w[FLASH_ROW_SIZE / sizeof(uint32_t)];
+    } data;
+    uint32_t row_addr;  /* base address of the cached row           */
+    uint32_t next_addr; /* address that continues the cached data   */
+    uint8_t  page_mask; /* bit n set when page n holds data; 0=empty */
+} row_cache;
+
+uint8_t *
+flash_cache_reserve(uint32_t addr, size_t *space)
+{
+    if ((row_cache.page_mask != 0U) && (addr != row_cache.next_addr)) {
+        flash_cache_flush();
+    }
+    if (row_cache.page_mask == 0U) {
+        row_cache.row_addr = addr & ~(FLASH_ROW_SIZE - 1U);
+        row_cache.next_addr = addr;
+        memset(row_cache.data.b, 0xFF, sizeof(row_cache.data.b));
+    }
+
+    uint32_t offset = addr - row_cache.row_addr;
+    *space = FLASH_ROW_SIZE - offset;
+    return &row_cache.data.b[offset];
+}
+
+void
+flash_cache_commit(size_t len)
+{
+    if (len == 0U) {
+        return;
+    }
+
+    uint32_t offset = row_cache.next_addr - row_cache.row_addr;
+    for (uint32_t page = offset / FLASH_PAGE_SIZE;
+         page <= (offset + len - 1U) / FLASH_PAGE_SIZE; ++page) {
+        row_cache.page_mask |= (uint8_t)(1U << page);
+    }
+    row_cache.next_addr += (uint32_t)len;
+
+    if ((offset + len) == FLASH_ROW_SIZE) {
+        flash_cache_flush();
+    }
+}
+
+void
+flash_cache_write(uint32_t addr, const uint8_t *data, size_t len)
+{
+    while (len > 0U) {
+        size_t space;
+        uint8_t *dst = flash_cache_reserve(addr, &space);
+        size_t chunk = (len < space) ? len : space;
+
+        memcpy(dst, data, chunk);
+        flash_cache_commit(chunk);
+
+        addr += (uint32_t)chunk;
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+void
+flash_cache_flush(void)
+{
+    for (uint32_t page = 0; page < (FLASH_ROW_SIZE / FLASH_PAGE_SIZE); ++page) {
+        if ((row_cache.page_mask & (1U << page)) != 0U) {
+            flash_program_page(row_cache.row_addr + page * FLASH_PAGE_SIZE,
+                               &row_cache.data.w[page * (FLASH_PAGE_SIZE / sizeof(uint32_t))]);
+        }
+    }
+    row_cache.page_mask = 0U;
+}
+
+void
+flash_cache_discard(void)
+{
+    row_cache.page_mask = 0U;
+}
+
+/* Write APP_VALID_MAGIC into APP_VALID_FLAG_ADDRESS, the word preceding
+ * the application start address.  This flag is used by main.c to
+ * decide whether a valid application exists.  The row containing this
+ * word must have been erased already. */
 void
 flash_set_app_valid_flag(void)
 {
-    uint32_t flag_addr = APP_START_ADDRESS - sizeof(uint32_t);
+    uint32_t flag_addr = APP_VALID_FLAG_ADDRESS;
     uint32_t page_addr = flag_addr & ~(FLASH_PAGE_SIZE - 1U);
     uint32_t offset = flag_addr - page_addr;
     union {
@@ -22,7 +22,7 @@
 /* Row size is four pages (256 bytes)【744331242867409†L156-L160】. */
 #define FLASH_ROW_SIZE  (FLASH_PAGE_SIZE * 4U)
 
-/* Application valid magic number stored immediately before APP_START. */
+/* Application valid magic number stored at APP_VALID_FLAG_ADDRESS. */
 #define APP_VALID_MAGIC 0x55AA13F0UL
 
 /* Initialise the flash controller.  Configures the NVM for manual
@@ -44,6 +44,33 @@ void flash_erase_range(uint32_t addr, size_t len);
  * beforehand. */
 void flash_write(uint32_t addr, const uint8_t *data, size_t len);
 
+/* Queue bytes for programming through the write-combining row cache.
+ * Consecutive calls that continue at the next address are merged into
+ * complete rows, so each row is programmed once no matter how the host
+ * splits its WRITE blocks; addr and len need no alignment.  The cache
+ * is flushed when a row fills up or when the next write does not
+ * continue where the previous one ended.  As with flash_write(), the
+ * target rows must already be erased. */
+void flash_cache_write(uint32_t addr, const uint8_t *data, size_t len);
+
+/* Zero-copy form of flash_cache_write() for callers that produce the
+ * data themselves.  flash_cache_reserve() returns where the byte for
+ * `addr` lives in the cached row, flushing first if `addr` does not
+ * continue the cached data, and stores in `space` how many bytes fit
+ * before the row ends.  The row buffer is word aligned, so the
+ * returned pointer has the same alignment as `addr`.  After filling up
+ * to `space` bytes the caller calls flash_cache_commit() with the count
+ * written. */
+uint8_t *flash_cache_reserve(uint32_t addr, size_t *space);
+void flash_cache_commit(size_t len);
+
+/* Program any partially filled row held in the cache.  Must be called
+ * before the written data is read back or the application is started. */
+void flash_cache_flush(void);
+
+/* Drop cached data without programming it (e.g. before an erase). */
+void flash_cache_discard(void);
+
 /* Mark the application as valid by writing APP_VALID_MAGIC into the
  * word immediately preceding the application start address.  The row
  * containing this word must be erased first. */
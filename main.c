@@ -5,6 +5,9 @@
 #include "protocol.h"
 #include "flash_ops.h"
 #include "crypto_ops.h"
+#include "app_hash.h"
+#include "fec.h"
+#include "ramfunc.h"
 #include "boot_config.h"
 
 #define REG8(addr)   (*(volatile uint8_t *)(addr))
@@ -95,6 +98,8 @@ static inline void __set_MSP(uint32_t topOfMainStack) {
 void usb_init(void);
 void usb_task(void);
 int usb_cdc_getchar(void);
+size_t usb_cdc_peek(const uint8_t **data);
+void usb_cdc_consume(size_t len);
 void usb_cdc_write(const uint8_t *data, size_t len);
 extern uint32_t usb_cdc_get_baud(void);
 extern uint16_t usb_cdc_get_line_state(void);
@@ -208,7 +213,7 @@ system_clock_init_arduino_zero(void)
 static bool
 check_bootloader_entry(void)
 {
-    const uint32_t *magic = (const uint32_t *)(APP_START_ADDRESS - 4);
+    const uint32_t *magic = (const uint32_t *)APP_VALID_FLAG_ADDRESS;
     if (*magic != APP_VALID_MAGIC) {
         return true;
     }
@@ -223,11 +228,25 @@ check_bootloader_entry(void)
     return false;
 }
 
+/* Publish APP_START_ADDRESS as the absolute symbol __app_start_address
+ * so samd21_boot.ld can check it against the region it was linked for
+ * (__boot_size).  The function itself is dropped by --gc-sections. */
+static void __attribute__((used))
+export_app_start_address(void)
+{
+    __asm volatile (".global __app_start_address\n\t"
+                    ".set __app_start_address, %c0" : : "i" (APP_START_ADDRESS));
+}
+
 void
 jump_to_application(uint32_t app_addr)
 {
     __disable_irq();
 
+    /* Stop SysTick in case the profiler left it interrupting; the
+     * application expects to find it disabled after reset. */
+    SYST_CSR = 0u;
+
     SCB_VTOR = app_addr;
 
     uint32_t sp = *((uint32_t *)app_addr);
@@ -254,14 +273,44 @@ main(void)
         jump_to_application(APP_START_ADDRESS);
     }
 
+    /* Staying in the bootloader: move the hot crypto kernels to SRAM
+     * before anything hashes or verifies. */
+    ramfunc_init();
+    crypto_init();
+
     flash_init();
     protocol_init();
+#ifdef BOOT_APP_HASH
+    app_hash_init();
+#endif
+#ifdef BOOT_FEC
+    fec_init();
+#endif
 
     for (;;) {
         usb_task();
+#ifdef BOOT_FEC
         int c = usb_cdc_getchar();
         if (c >= 0) {
-            protocol_process_char((uint8_t)c);
+            fec_process_char((uint8_t)c);
+            continue;
+        }
+#else
+        /* Hand the parser everything that is contiguous in the RX ring
+         * so WRITE payload is processed in place.  A command runs only
+         * once its line has left the ring, so an applet started by RUN
+         * reads what follows it. */
+        const uint8_t *data;
+        size_t len = usb_cdc_peek(&data);
+        if (len > 0u) {
+            usb_cdc_consume(protocol_process(data, len));
+            protocol_dispatch();
+            continue;
         }
+#endif
+#ifdef BOOT_APP_HASH
+        /* Nothing from the host: hash the resident image meanwhile */
+        app_hash_idle_step();
+#endif
     }
 }
@@ -0,0 +1,179 @@
+/*
+ * profile.c - Statistical PC-sampling profiler
+ *
+ * The SysTick exception handler reads the PC from the hardware stacked
+ * exception frame and increments the histogram bucket that contains
+ * it.  Samples in the .ramfunc code copied to SRAM are charged to the
+ * flash image of that code, so they symbolise like the rest.  Other
+ * samples outside the bootloader region are counted separately: `ram`
+ * covers code executing from SRAM (e.g. an applet) and `other`
+ * everything else.  Bucket counters saturate rather than wrap so a
+ * long capture cannot corrupt the profile.
+ */
+
+#include "profile.h"
+#include "boot_config.h"
+#include "crypto_ops.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/* External functions provided by the USB layer */
+extern void usb_cdc_write(const uint8_t *data, size_t len);
+
+#define SYSTICK_BASE            (0xE000E010u)
+#define SYST_CSR                (*(volatile uint32_t *)(SYSTICK_BASE + 0x00u))
+#define SYST_RVR                (*(volatile uint32_t *)(SYSTICK_BASE + 0x04u))
+#define SYST_CVR                (*(volatile uint32_t *)(SYSTICK_BASE + 0x08u))
+#define SYST_CSR_ENABLE         (1u << 0)
+#define SYST_CSR_TICKINT        (1u << 1)
+#define SYST_CSR_CLKSOURCE      (1u << 2)
+
+#define SRAM_START              (0x20000000UL)
+#define SRAM_SIZE               (32UL * 1024UL)
+
+/* .ramfunc run and load addresses (samd21_boot.ld) */
+extern uint32_t _siramfunc, _sramfunc, _eramfunc;
+
+/* Amount of application flash hashed by profile_bench(). */
+#define BENCH_HASH_BYTES        (16u * 1024u)
+
+static struct {
+    uint16_t bucket[PROFILE_BUCKET_COUNT];
+    uint32_t samples;
+    uint32_t ram;
+    uint32_t other;
+} profile;
+
+/* Called from SysTick_Handler with the interrupted PC. */
+static void __attribute__((used))
+profile_record(uint32_t pc)
+{
+    profile.samples++;
+    uint32_t ram_code = (uint32_t)(uintptr_t)&_sramfunc;
+    if ((pc - ram_code) < ((uint32_t)(uintptr_t)&_eramfunc - ram_code)) {
+        pc = pc - ram_code + (uint32_t)(uintptr_t)&_siramfunc;
+    }
+    if (pc < APP_START_ADDRESS) {
+        uint16_t *slot = &profile.bucket[pc >> PROFILE_BUCKET_SHIFT];
+        if (*slot != UINT16_MAX) {
+            (*slot)++;
+        }
+    } else if ((pc - SRAM_START) < SRAM_SIZE) {
+        profile.ram++;
+    } else {
+        profile.other++;
+    }
+}
+
+/* The bootloader only ever runs on MSP, so the exception frame is at
+ * the top of the main stack and the stacked PC is its seventh word.
+ * r4 is pushed alongside lr purely to keep the stack 8-byte aligned. */
+__attribute__((naked)) void
+SysTick_Handler(void)
+{
+    __asm volatile (
+        "mrs  r0, msp          \n"
+        "ldr  r0, [r0, #24]    \n"
+        "push {r4, lr}         \n"
+        "bl   profile_record   \n"
+        "pop  {r4, pc}         \n"
+    );
+}
+
+void
+profile_start(void)
+{
+    SYST_CSR = 0u;
+    memset(&profile, 0, sizeof(profile));
+    SYST_RVR = PROFILE_SYSTICK_RELOAD;
+    SYST_CVR = 0u;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+}
+
+void
+profile_stop(void)
+{
+    SYST_CSR = 0u;
+}
+
+static void
+send_line(const char *s)
+{
+    usb_cdc_write((const uint8_t *)s, strlen(s));
+}
+
+void
+profile_dump(void)
+{
+    char line[48];
+    snprintf(line, sizeof(line), "PROF %u %u %u %u\n",
+             (unsigned)PROFILE_BUCKET_SHIFT, (unsigned)profile.samples,
+             (unsigned)profile.ram, (unsigned)profile.other);
+    send_line(line);
+    for (size_t i = 0; i < PROFILE_BUCKET_COUNT; i++) {
+        if (profile.bucket[i] != 0u) {
+            snprintf(line, sizeof(line), "%u %u\n",
+                     (unsigned)(i << PROFILE_BUCKET_SHIFT),
+                     (unsigned)profile.bucket[i]);
+            send_line(line);
+        }
+    }
+    send_line("OK PROF\n");
+}
+
+/* Cycles since profile_start(): whole sampling periods counted by the
+ * handler plus the progress of the current one.  The sample count is
+ * read twice so a tick between the two reads is not lost. */
+static uint32_t
+profile_cycles(void)
+{
+    volatile uint32_t *samples = &profile.samples;
+    uint32_t n, cvr;
+    do {
+        n = *samples;
+        cvr = SYST_CVR;
+    } while (n != *samples);
+    return n * (PROFILE_SYSTICK_RELOAD + 1u) + (PROFILE_SYSTICK_RELOAD - cvr);
+}
+
+static void
+bench_line(const char *name, uint32_t bytes, uint32_t cycles)
+{
+    char line[48];
+    snprintf(line, sizeof(line), "BENCH %s %u %u\n", name,
+             (unsigned)bytes, (unsigned)cycles);
+    send_line(line);
+}
+
+void
+profile_bench(void)
+{
+    const uint8_t *data = (const uint8_t *)APP_START_ADDRESS;
+    crypto_sha256_ctx_t ctx;
+    uint8_t digest[32];
+    uint8_t signature[64];
+    uint32_t t0, t1, t2, t3;
+
+    /* Any 64 bytes with S < L cost a full verification; this one just
+     * fails the final comparison. */
+    memset(signature, 0, sizeof(signature));
+
+    profile_start();
+    t0 = profile_cycles();
+    crypto_sha256_ctx_init(&ctx);
+    crypto_sha256_ctx_update(&ctx, data, BENCH_HASH_BYTES);
+    crypto_sha256_ctx_final(&ctx, digest);
+    t1 = profile_cycles();
+    (void)crypto_crc32_update(0xFFFFFFFFUL, data, BENCH_HASH_BYTES);
+    t2 = profile_cycles();
+    (void)crypto_ed25519_verify(signature, digest);
+    t3 = profile_cycles();
+    profile_stop();
+
+    bench_line("sha256", BENCH_HASH_BYTES, t1 - t0);
+    bench_line("crc32", BENCH_HASH_BYTES, t2 - t1);
+    bench_line("ed25519", 0u, t3 - t2);
+    send_line("OK BENCH\n");
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+/*
+ * profile.h - Statistical PC-sampling profiler
+ *
+ * Optional on-target profiler built when BOOT_PROFILE is defined
+ * (`make PROFILE=1`).  SysTick is reprogrammed to interrupt at roughly
+ * 10 kHz and the handler records the stacked PC of the interrupted code
+ * into a histogram of fixed-size address buckets covering the
+ * bootloader region.  The histogram is dumped over the command channel
+ * and symbolised on the host with tools/profile_symbolize.py.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include "boot_config.h"
+
+/* Each bucket covers 2^PROFILE_BUCKET_SHIFT bytes of bootloader code. */
+#define PROFILE_BUCKET_SHIFT  5u
+#define PROFILE_BUCKET_COUNT  (APP_START_ADDRESS >> PROFILE_BUCKET_SHIFT)
+
+/* SysTick reload for the sampling period.  4801 cycles at 48 MHz is
+ * just over 100 us; the odd period keeps the sampler from locking onto
+ * loops that run on a 1 ms grid. */
+#define PROFILE_SYSTICK_RELOAD (4801u - 1u)
+
+/* Clear the histogram and start sampling. */
+void profile_start(void);
+
+/* Stop sampling.  The histogram is preserved until the next start. */
+void profile_stop(void);
+
+/* Send the histogram to the host.  The output consists of a header
+ * line "PROF <bucket_shift> <samples> <ram> <other>", one
+ * "<address> <count>" line per non-empty bucket and a final
+ * "OK PROF" line.  All numbers are decimal. */
+void profile_dump(void);
+
+/* Time SHA‑256 and CRC32 over the first 16 KiB of the application
+ * region and one Ed25519 verification, in CPU cycles at 48 MHz.  The
+ * output is one "BENCH <name> <bytes> <cycles>" line per kernel and a
+ * final "OK BENCH" line.  The run is profiled, so a PROF DUMP afterwards
+ * shows where the time went.  Compare a default build with one made
+ * with `make RAMFUNC=0` to see the effect of running from SRAM. */
+void profile_bench(void);
+
+#endif /* PROFILE_H */
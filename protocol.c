@@ -9,19 +9,47 @@
  *                     followed by <len> binary bytes to program.
  *                     After all bytes are received the block CRC is
  *                     verified and the firmware SHA‑256 hash is updated.
+ *   SYNC\n            -> programs any partially filled row held in the
+ *                     write-combining cache and replies OK SYNC\n.
  *   DONE <signature_hex>\n -> verifies the Ed25519 signature of the
  *                     firmware hash and jumps to the application on
  *                     success.
+ *   CRC <addr>\n      -> replies with OK CRC <crc32_hex>\n for the flash
+ *                     row at <addr> (row aligned, application region).
+ *   HASH APP\n        -> replies with OK HASH <sha256_hex>\n of the
+ *                     whole application region.  CRC and HASH APP are
+ *                     only in BOOT_APP_HASH builds (see app_hash.h).
+ *   FEC ON|OFF\n      -> switches Reed–Solomon framing of host data on
+ *                     or off (only in BOOT_FEC builds, see fec.h).
+ *   STATS\n           -> reports link statistics (FEC counters; only in
+ *                     BOOT_FEC builds).
+ *   PROF START|STOP|DUMP|BENCH\n -> controls the optional PC-sampling
+ *                     profiler and runs the crypto timing benchmark
+ *                     (only in BOOT_PROFILE builds).
+ *   APPLET <len> <crc32>\n
+ *                     followed by <len> binary bytes of a RAM applet
+ *                     (see applet.h).  Replies OK APPLET or ERR CRC.
+ *   RUN <signature_hex> [args]\n -> verifies the applet signature,
+ *                     calls it and replies OK RUN <return value>.
+ *                     APPLET and RUN are only in BOOT_APPLET builds.
  *
  * The parser is intentionally simple and does not allocate large
- * buffers.  Binary data is written to flash page by page to
- * conserve RAM.  CRC32 (IEEE 802.3) is calculated incrementally.
+ * buffers.  Binary data is handed to the flash write-combining
+ * cache, which merges consecutive WRITE blocks into whole rows.
+ * CRC32 (IEEE 802.3) is calculated incrementally.
+ * CRC and HASH APP are answered from the app_hash cache, which is
+ * filled while the device waits for the host.  WRITE only invalidates
+ * the rows it covers.
  */
 
 #include "protocol.h"
 #include "flash_ops.h"
 #include "boot_config.h"
 #include "crypto_ops.h"
+#include "app_hash.h"
+#include "applet.h"
+#include "fec.h"
+#include "profile.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,17 +64,22 @@ extern void jump_to_application(uint32_t app_addr);
 #define BOOT_VERSION_MAJOR 1
 #define BOOT_VERSION_MINOR 0
 
-/* Maximum length for a single command line (excluding binary data). */
-#define CMD_BUF_SIZE 128
+/* Maximum length for a single command line (excluding binary data).
+ * DONE and RUN carry a 128-character signature plus the command word,
+ * and RUN may be followed by applet arguments. */
+#define CMD_BUF_SIZE 256
 
 /* Internal parser state */
 static enum {
     STATE_WAIT_CMD,  /* waiting for a newline‑terminated text command */
-    STATE_WRITE_DATA /* receiving binary data for WRITE command        */
+    STATE_WRITE_DATA, /* receiving binary data for WRITE command       */
+    STATE_APPLET_DATA /* receiving binary data for APPLET command      */
 } parser_state;
 
 static char   cmd_buffer[CMD_BUF_SIZE]; /* command line buffer */
 static size_t cmd_index;
+static bool   cmd_ready; /* cmd_buffer holds a complete line that
+                          * protocol_dispatch() has not run yet   */
 
 /* Variables used during a WRITE command */
 static uint32_t write_addr;
@@ -54,26 +87,10 @@ static uint32_t write_length;
 static uint32_t write_expected_crc;
 static size_t   write_received;
 static uint32_t crc_accum;
-static uint8_t  page_buffer[FLASH_ROW_SIZE];
-static size_t   page_index;
-
-/* CRC32 calculation using the standard polynomial (0xEDB88320).  The
- * algorithm starts with crc_accum initialised to 0xFFFFFFFF and ends
- * with a final XOR with 0xFFFFFFFF. */
-static uint32_t
-crc32_update(uint32_t crc, uint8_t data)
-{
-    crc ^= data;
-    for (int i = 0; i < 8; i++) {
-        if (crc & 1) {
-            crc = (crc >> 1) ^ 0xEDB88320UL;
-        } else {
-            crc >>= 1;
-        }
-    }
-    return crc;
-}
 
+/* CRC32 uses the standard polynomial (0xEDB88320) via
+ * crypto_crc32_update().  crc_accum starts at 0xFFFFFFFF and ends with
+ * a final XOR with 0xFFFFFFFF. */
 static uint32_t
 crc32_finalize(uint32_t crc)
 {
@@ -87,22 +104,90 @@ send_str(const char *s)
     usb_cdc_write((const uint8_t *)s, strlen(s));
 }
 
+/* Format `len` bytes as lowercase hex into `out`, which must hold
+ * 2 * len + 1 characters. */
+static void
+format_hex(char *out, const uint8_t *data, size_t len)
+{
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < len; i++) {
+        out[i * 2]     = digits[data[i] >> 4];
+        out[i * 2 + 1] = digits[data[i] & 0x0Fu];
+    }
+    out[len * 2] = '\0';
+}
+
 void
 protocol_init(void)
 {
     parser_state   = STATE_WAIT_CMD;
     cmd_index      = 0;
     cmd_buffer[0]  = '\0';
+    cmd_ready      = false;
     write_addr     = 0;
     write_length   = 0;
     write_expected_crc = 0;
     write_received = 0;
     crc_accum      = 0xFFFFFFFFUL;
-    page_index     = 0;
     /* Initialise crypto hash context */
     crypto_sha256_init();
 }
 
+/* Parse a 128-character hex string into a 64-byte signature.  Returns
+ * false on a malformed string. */
+static bool
+parse_signature(const char *sig_hex, uint8_t signature[64])
+{
+    for (size_t i = 0; i < 64; i++) {
+        char tmp[3] = { sig_hex[i * 2], sig_hex[i * 2 + 1], '\0' };
+        char *endp;
+        unsigned long v = strtoul(tmp, &endp, 16);
+        if (tmp[0] == '\0' || *endp != '\0' || v > 0xFFUL) {
+            return false;
+        }
+        signature[i] = (uint8_t)v;
+    }
+    return true;
+}
+
+#ifdef BOOT_APPLET
+/* Complete an APPLET upload: check the CRC and go back to waiting for
+ * commands. */
+static void
+applet_finish(void)
+{
+    if (crc32_finalize(crc_accum) == write_expected_crc) {
+        send_str("OK APPLET\n");
+    } else {
+        /* Nothing runs without a valid signature anyway, but tell the
+         * host so it can resend. */
+        send_str("ERR CRC\n");
+    }
+    parser_state = STATE_WAIT_CMD;
+    crc_accum    = 0xFFFFFFFFUL;
+}
+#endif
+
+/* Complete a WRITE block: check the CRC, reply and go back to
+ * waiting for commands. */
+static void
+write_finish(void)
+{
+    uint32_t crc_final = crc32_finalize(crc_accum);
+    if (crc_final == write_expected_crc) {
+        send_str("OK WRITE\n");
+    } else {
+        /* CRC mismatch – the block was written anyway.  The
+         * host can re‑send the block if necessary. */
+        send_str("ERR CRC\n");
+    }
+    /* Reset state to accept the next command */
+    parser_state = STATE_WAIT_CMD;
+    write_length   = 0;
+    write_received = 0;
+    crc_accum      = 0xFFFFFFFFUL;
+}
+
 /* Parse and execute a completed text command line.  This function
  * handles command dispatch and argument validation. */
 static void
@@ -122,7 +207,11 @@ handle_command(void)
     }
     /* ERASE APP */
     if (strcmp(cmd_buffer, "ERASE APP") == 0) {
+        flash_cache_discard();
         flash_erase_application();
+#ifdef BOOT_APP_HASH
+        app_hash_invalidate();
+#endif
         /* Reset hash context when erasing */
         crypto_sha256_init();
         send_str("OK ERASE\n");
@@ -144,30 +233,75 @@ handle_command(void)
         uint32_t length = (uint32_t)strtoul(len_str, NULL, 0);
         uint32_t crc    = (uint32_t)strtoul(crc_str, NULL, 0);
         /* Validate address and length.  Ensure the write stays within
-         * the application region.  The end of flash is defined by
-         * FLASH_SIZE in flash_ops.h.
-         *
-         * NOTE: APP_START_ADDRESS is defined in main.c.  To ensure
-         * this file can compile independently (e.g. in unit tests),
-         * define a fallback value when it is not provided via
-         * compilation flags.  The default corresponds to an 8 KiB
-         * bootloader region (0x0000–0x1FFF). */
-        if (addr < APP_START_ADDRESS || (addr + length) > FLASH_SIZE) {
+         * the application region, from APP_START_ADDRESS (boot_config.h,
+         * follows the bootloader size) to FLASH_SIZE (flash_ops.h).  The
+         * length is checked against the room left so that a huge value
+         * cannot wrap the end address around. */
+        if (addr < APP_START_ADDRESS || addr > FLASH_SIZE ||
+            length > (FLASH_SIZE - addr)) {
             send_str("ERR PARAM\n");
             return;
         }
+#ifdef BOOT_APP_HASH
+        /* These rows of the resident image are about to change */
+        app_hash_invalidate_range(addr, length);
+#endif
         /* Initialise write state */
         write_addr        = addr;
         write_length      = length;
         write_expected_crc= crc;
         write_received    = 0;
         crc_accum         = 0xFFFFFFFFUL;
-        page_index        = 0;
         parser_state      = STATE_WRITE_DATA;
         /* No reply is sent yet; the response occurs after the data block is
-         * received and the CRC has been checked. */
+         * received and the CRC has been checked.  An empty block has
+         * nothing to wait for. */
+        if (length == 0) {
+            write_finish();
+        }
+        return;
+    }
+    /* SYNC */
+    if (strcmp(cmd_buffer, "SYNC") == 0) {
+        flash_cache_flush();
+        send_str("OK SYNC\n");
+        return;
+    }
+#ifdef BOOT_APP_HASH
+    /* CRC <addr> */
+    if (strncmp(cmd_buffer, "CRC ", 4) == 0) {
+        uint32_t addr = (uint32_t)strtoul(cmd_buffer + 4, NULL, 0);
+        if (addr < APP_START_ADDRESS || addr >= FLASH_SIZE ||
+            (addr & (FLASH_ROW_SIZE - 1U)) != 0U) {
+            send_str("ERR PARAM\n");
+            return;
+        }
+        flash_cache_flush();
+        uint32_t crc = app_hash_row_crc(addr);
+        uint8_t crc_be[4] = {
+            (uint8_t)(crc >> 24), (uint8_t)(crc >> 16),
+            (uint8_t)(crc >> 8),  (uint8_t)crc
+        };
+        char reply[24] = "OK CRC ";
+        format_hex(&reply[7], crc_be, sizeof(crc_be));
+        reply[15] = '\n';
+        reply[16] = '\0';
+        send_str(reply);
+        return;
+    }
+    /* HASH APP */
+    if (strcmp(cmd_buffer, "HASH APP") == 0) {
+        uint8_t digest[32];
+        flash_cache_flush();
+        app_hash_digest(digest);
+        char reply[8 + 64 + 2] = "OK HASH ";
+        format_hex(&reply[8], digest, sizeof(digest));
+        reply[72] = '\n';
+        reply[73] = '\0';
+        send_str(reply);
         return;
     }
+#endif
     /* DONE */
     if (strncmp(cmd_buffer, "DONE ", 5) == 0) {
         /* The signature is provided as a 128‑character hex string.
@@ -179,21 +313,12 @@ handle_command(void)
             return;
         }
         uint8_t signature[64];
-        bool ok = true;
-        for (size_t i = 0; i < 64; i++) {
-            char tmp[3] = { sig_hex[i * 2], sig_hex[i * 2 + 1], '\0' };
-            char *endp;
-            unsigned long v = strtoul(tmp, &endp, 16);
-            if (*endp != '\0' || v > 0xFFUL) {
-                ok = false;
-                break;
-            }
-            signature[i] = (uint8_t)v;
-        }
-        if (!ok) {
+        if (!parse_signature(sig_hex, signature)) {
             send_str("ERR FORMAT\n");
             return;
         }
+        /* Program whatever the row cache still holds */
+        flash_cache_flush();
         /* Finalise the SHA‑256 hash of the firmware */
         uint8_t digest[32];
         crypto_sha256_final(digest);
@@ -211,63 +336,162 @@ handle_command(void)
         }
         return;
     }
+#ifdef BOOT_APPLET
+    /* APPLET <len> <crc32> */
+    if (strncmp(cmd_buffer, "APPLET ", 7) == 0) {
+        char *len_str = strtok(cmd_buffer + 7, " ");
+        char *crc_str = strtok(NULL, " ");
+        if (!len_str || !crc_str) {
+            send_str("ERR FORMAT\n");
+            return;
+        }
+        uint32_t length = (uint32_t)strtoul(len_str, NULL, 0);
+        if (!applet_begin(length)) {
+            send_str("ERR PARAM\n");
+            return;
+        }
+        write_expected_crc = (uint32_t)strtoul(crc_str, NULL, 0);
+        crc_accum          = 0xFFFFFFFFUL;
+        parser_state       = STATE_APPLET_DATA;
+        if (length == 0) {
+            applet_finish();
+        }
+        return;
+    }
+    /* RUN <signature_hex> [args] */
+    if (strncmp(cmd_buffer, "RUN ", 4) == 0) {
+        const char *sig_hex = cmd_buffer + 4;
+        size_t sig_hex_len = strlen(sig_hex);
+        uint8_t signature[64];
+        if (sig_hex_len < 128 || (sig_hex_len > 128 && sig_hex[128] != ' ') ||
+            !parse_signature(sig_hex, signature)) {
+            send_str("ERR FORMAT\n");
+            return;
+        }
+        const char *args = (sig_hex_len > 128) ? &sig_hex[129] : "";
+        int ret = 0;
+        switch (applet_run(signature, args, &ret)) {
+        case APPLET_OK: {
+            char reply[24];
+            snprintf(reply, sizeof(reply), "OK RUN %d\n", ret);
+            send_str(reply);
+            break;
+        }
+        case APPLET_ERR_SIGNATURE:
+            send_str("ERR SIGNATURE\n");
+            break;
+        case APPLET_ERR_EMPTY:
+        case APPLET_ERR_FORMAT:
+        default:
+            send_str("ERR APPLET\n");
+            break;
+        }
+        return;
+    }
+#endif
+#ifdef BOOT_FEC
+    /* FEC ON | FEC OFF.  The reply to FEC ON is sent before framing
+     * starts; FEC OFF arrives inside a frame and ends framing. */
+    if (strcmp(cmd_buffer, "FEC ON") == 0) {
+        send_str("OK FEC\n");
+        fec_enable(true);
+        return;
+    }
+    if (strcmp(cmd_buffer, "FEC OFF") == 0) {
+        fec_enable(false);
+        send_str("OK FEC\n");
+        return;
+    }
+    /* STATS */
+    if (strcmp(cmd_buffer, "STATS") == 0) {
+        const fec_stats_t *fs = fec_get_stats();
+        char reply[80];
+        snprintf(reply, sizeof(reply),
+                 "OK STATS fec_frames=%u fec_corrected=%u fec_failed=%u\n",
+                 (unsigned)fs->frames, (unsigned)fs->corrected_bytes,
+                 (unsigned)fs->failed_frames);
+        send_str(reply);
+        return;
+    }
+#endif
+#ifdef BOOT_PROFILE
+    /* PROF START | PROF STOP | PROF DUMP | PROF BENCH */
+    if (strcmp(cmd_buffer, "PROF START") == 0) {
+        profile_start();
+        send_str("OK PROF\n");
+        return;
+    }
+    if (strcmp(cmd_buffer, "PROF STOP") == 0) {
+        profile_stop();
+        send_str("OK PROF\n");
+        return;
+    }
+    if (strcmp(cmd_buffer, "PROF DUMP") == 0) {
+        profile_dump();
+        return;
+    }
+    if (strcmp(cmd_buffer, "PROF BENCH") == 0) {
+        profile_bench();
+        return;
+    }
+#endif
     /* Unknown command */
     send_str("ERR UNKNOWN\n");
 }
 
-void
-protocol_process_char(uint8_t c)
+/* Consume WRITE payload bytes from `data`.  Bytes are copied straight
+ * into the row cache by the fused kernel, which updates the block CRC
+ * and the firmware SHA‑256 in the same pass.  Returns the number of
+ * bytes consumed. */
+static size_t
+write_data(const uint8_t *data, size_t len)
 {
-    if (parser_state == STATE_WRITE_DATA) {
-        /* Accumulate binary bytes until the expected number of bytes
-         * has been received.  Update CRC and SHA‑256 incrementally. */
-        crc_accum = crc32_update(crc_accum, c);
-        crypto_sha256_update(&c, 1);
-        /* Buffer the data until we have a full page or until the end
-         * of the block.  Flash writes must be aligned to a page size
-         * of 64 bytes on the SAMD21【582320296557380†L4648-L4654】; four pages form
-         * an erase row【744331242867409†L156-L160】, but the flash driver handles
-         * page writes transparently. */
-        page_buffer[page_index++] = c;
-        write_received++;
-        if (page_index >= FLASH_PAGE_SIZE) {
-            flash_write(write_addr, page_buffer, page_index);
-            write_addr += page_index;
-            page_index = 0;
-        }
-        /* When the entire block has been received we perform CRC
-         * verification and send the response. */
-        if (write_received >= write_length) {
-            /* Write any remaining buffered data */
-            if (page_index > 0) {
-                flash_write(write_addr, page_buffer, page_index);
-                write_addr += page_index;
-                page_index = 0;
-            }
-            /* Finalise CRC */
-            uint32_t crc_final = crc32_finalize(crc_accum);
-            if (crc_final == write_expected_crc) {
-                send_str("OK WRITE\n");
-            } else {
-                /* CRC mismatch – the block was written anyway.  The
-                 * host can re‑send the block if necessary. */
-                send_str("ERR CRC\n");
-            }
-            /* Reset state to accept the next command */
-            parser_state = STATE_WAIT_CMD;
-            write_length   = 0;
-            write_received = 0;
-            crc_accum      = 0xFFFFFFFFUL;
-        }
-        return;
+    size_t want = write_length - write_received;
+    size_t used = (len < want) ? len : want;
+    size_t left = used;
+
+    while (left > 0) {
+        size_t space;
+        uint8_t *dst = flash_cache_reserve(write_addr, &space);
+        size_t chunk = (left < space) ? left : space;
+        crc_accum = crypto_crc32_sha256_copy(crc_accum, dst, data, chunk);
+        flash_cache_commit(chunk);
+        write_addr     += (uint32_t)chunk;
+        write_received += chunk;
+        data += chunk;
+        left -= chunk;
+    }
+
+    /* When the entire block has been received we perform CRC
+     * verification and send the response. */
+    if (write_received >= write_length) {
+        write_finish();
+    }
+    return used;
+}
+
+#ifdef BOOT_APPLET
+/* Consume APPLET payload bytes from `data` into the applet buffer.
+ * Returns the number of bytes consumed. */
+static size_t
+applet_bytes(const uint8_t *data, size_t len)
+{
+    size_t used = applet_data(data, len);
+    crc_accum = crypto_crc32_update(crc_accum, data, used);
+    if (applet_remaining() == 0) {
+        applet_finish();
     }
-    /* STATE_WAIT_CMD: accumulate characters until a newline */
+    return used;
+}
+#endif
+
+/* STATE_WAIT_CMD: accumulate characters until a newline */
+static void
+command_char(uint8_t c)
+{
     if (c == '\n') {
-        /* Complete command received */
-        handle_command();
-        /* Clear buffer for next command */
-        cmd_index = 0;
-        cmd_buffer[0] = '\0';
+        /* Complete command received; protocol_dispatch() runs it */
+        cmd_ready = true;
     } else {
         /* Ignore carriage returns */
         if (c == '\r') {
@@ -283,4 +507,42 @@ protocol_process_char(uint8_t c)
             cmd_buffer[0] = '\0';
         }
     }
+}
+
+size_t
+protocol_process(const uint8_t *data, size_t len)
+{
+    size_t used = 0;
+    while (used < len && !cmd_ready) {
+        if (parser_state == STATE_WRITE_DATA) {
+            used += write_data(&data[used], len - used);
+#ifdef BOOT_APPLET
+        } else if (parser_state == STATE_APPLET_DATA) {
+            used += applet_bytes(&data[used], len - used);
+#endif
+        } else {
+            command_char(data[used++]);
+        }
+    }
+    return used;
+}
+
+void
+protocol_dispatch(void)
+{
+    if (!cmd_ready) {
+        return;
+    }
+    cmd_ready = false;
+    handle_command();
+    /* Clear buffer for next command */
+    cmd_index = 0;
+    cmd_buffer[0] = '\0';
+}
+
+void
+protocol_process_char(uint8_t c)
+{
+    protocol_process(&c, 1);
+    protocol_dispatch();
 }
\ No newline at end of file
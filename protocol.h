@@ -9,6 +9,7 @@
 #define PROTOCOL_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 /* Initialise the protocol parser.  Must be called once before
  * processing any characters.  Resets the internal SHA‑256 context
@@ -21,4 +22,17 @@ void protocol_init(void);
  * immediately after the command. */
 void protocol_process_char(uint8_t c);
 
+/* Process up to `len` bytes from the host in one call.  WRITE payload
+ * is consumed in bulk so the data path can copy, CRC and hash it in a
+ * single pass.  Stops after the newline of a command line without
+ * running the command, and returns the number of bytes used; the caller
+ * releases them from its receive buffer and then calls
+ * protocol_dispatch(). */
+size_t protocol_process(const uint8_t *data, size_t len);
+
+/* Run the command line completed by the last protocol_process() call,
+ * if any.  Commands run only after their line has been consumed, so an
+ * applet started by RUN reads the host data that follows the line. */
+void protocol_dispatch(void);
+
 #endif /* PROTOCOL_H */
\ No newline at end of file
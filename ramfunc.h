@@ -0,0 +1,44 @@
+/*
+ * ramfunc.h - Run selected functions from SRAM
+ *
+ * At 48 MHz the NVM needs one wait state, so instruction fetches from
+ * flash stall in the tight crypto and CRC loops.  SRAM is zero wait
+ * state.  Functions defined with RAMFUNC(name) are placed in their own
+ * .ramfunc.<name> section.  The linker script collects these into the
+ * .ramfunc output section, which is linked to run from SRAM and stored
+ * in flash.
+ *
+ * The copy is not done at reset, so the fast path that jumps straight
+ * to the application pays nothing for it.  main() calls ramfunc_init()
+ * once it has decided to stay in the bootloader, and no RAMFUNC may run
+ * before that.
+ *
+ * Flash and SRAM are further apart than a Thumb BL can reach.  long_call
+ * makes calls within a file use an absolute address.  It is also part
+ * of the function type, so a RAMFUNC must be static: a prototype in a
+ * header, or a function pointer, without the attribute would conflict
+ * with it.  Other files call a plain wrapper in flash.  Build with
+ * `make RAMFUNC=0` to keep everything in flash, e.g. to compare timings
+ * with PROF BENCH.  Host builds of these files ignore the macro.
+ * Constant tables read in those loops go along with RAMDATA(name).
+ *
+ *     static void RAMFUNC(fe51_mul)(fe51 *r, const fe51 *a, const fe51 *b)
+ *     static const uint32_t RAMDATA(sha256_k)[64] = { ... };
+ */
+
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+#if !defined(BOOT_NO_RAMFUNC) && defined(__arm__)
+#define RAMFUNC(name) \
+    __attribute__((section(".ramfunc." #name), noinline, long_call)) name
+#define RAMDATA(name) __attribute__((section(".ramfunc." #name))) name
+#else
+#define RAMFUNC(name) name
+#define RAMDATA(name) name
+#endif
+
+/* Copy the .ramfunc section from flash to SRAM. */
+void ramfunc_init(void);
+
+#endif /* RAMFUNC_H */
@@ -11,6 +11,7 @@
 // Prototipos
 void Reset_Handler(void);
 void Default_Handler(void);
+void SysTick_Handler(void);
 
 // Declarar main() (está en main.c)
 int main(void);
@@ -26,7 +27,7 @@ const void *vector_table[] = {
   (void *)Default_Handler, (void *)Default_Handler, (void *)Default_Handler,
   (void *)Default_Handler, (void *)Default_Handler, (void *)Default_Handler,
   (void *)Default_Handler, (void *)Default_Handler, (void *)Default_Handler,
-  (void *)Default_Handler, (void *)Default_Handler, (void *)Default_Handler
+  (void *)Default_Handler, (void *)Default_Handler, (void *)SysTick_Handler
 };
 
 // Handlers débiles para interrupciones (todas a Default_Handler)
@@ -34,6 +35,9 @@ void __attribute__((weak)) Default_Handler(void) {
   while (1) { __asm volatile ("nop"); }
 }
 
+// SysTick solo interrumpe cuando el profiler está activo (profile.c)
+void SysTick_Handler(void) __attribute__((weak, alias("Default_Handler")));
+
 // Pequeña rutina de copia/zero de .data/.bss (opcional mínima)
 extern uint32_t _sidata, _sdata, _edata, _sbss, _ebss;
 
@@ -45,6 +49,20 @@ static void init_data_bss(void) {
   while (dst < &_ebss)  { *dst++ = 0; }
 }
 
+// Copia de .ramfunc (ver ramfunc.h). No forma parte de init_data_bss():
+// main() la llama solo al quedarse en modo bootloader, así el salto
+// directo a la aplicación no paga la copia.
+extern uint32_t _siramfunc, _sramfunc, _eramfunc;
+
+// Con RAMFUNC=0 la sección se enlaza en flash (VMA == LMA) y no hay
+// nada que copiar; escribir en esas direcciones iría al controlador NVM.
+void ramfunc_init(void) {
+  uint32_t *src = &_siramfunc;
+  uint32_t *dst = &_sramfunc;
+  if (src == dst) { return; }
+  while (dst < &_eramfunc) { *dst++ = *src++; }
+}
+
 // Reset: init básica y salto a main()
 void __attribute__((noreturn)) Reset_Handler(void) {
   init_data_bss();
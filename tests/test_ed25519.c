@@ -0,0 +1,205 @@
+/*
+ * test_ed25519.c - Host test for crypto_ed25519_verify()
+ *
+ * The vectors were made with the Python cryptography package from fixed
+ * seeds: one valid signature per key over a 32-byte image hash, plus
+ * tampered R, S and hash bits, non-canonical S values (S + L and
+ * S = L), the wrong public key and a public key that is not a curve point.
+ *
+ * The verifier always checks against ZK_PUBKEY, so the test builds
+ * crypto_ops.c into itself with ZK_PUBKEY redirected to a writable
+ * array that each vector fills in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ZK_PUBKEY zk_pubkey_builtin
+#include "crypto_ops.h"
+#undef ZK_PUBKEY
+static uint8_t ZK_PUBKEY[32];
+#include "crypto_ops.c"
+
+typedef struct {
+    const char *pubkey;
+    const char *signature;
+    const char *hash;
+    bool        valid;
+} vector_t;
+
+static const vector_t vectors[] = {
+    { /* valid */
+        "4e09dfe87e243623edf3e15bd25237de124549f390e3b47ceca3f77b315e6811",
+        "5c97a210914342c49812f18d5fd42d5b60d8985dd45088f9ad6d0503cf0c94bd"
+        "a6da7274ff3b42020625add7c4f5df0134d57eb82b6f134b790d49d67379e40f",
+        "26b6d98f328a39321ff920228b8625eee0037a09332d68cd783841fb4b4e8fb4",
+        true
+    },
+    { /* R bit flipped */
+        "4e09dfe87e243623edf3e15bd25237de124549f390e3b47ceca3f77b315e6811",
+        "5d97a210914342c49812f18d5fd42d5b60d8985dd45088f9ad6d0503cf0c94bd"
+        "a6da7274ff3b42020625add7c4f5df0134d57eb82b6f134b790d49d67379e40f",
+        "26b6d98f328a39321ff920228b8625eee0037a09332d68cd783841fb4b4e8fb4",
+        false
+    },
+    { /* S bit flipped */
+        "4e09dfe87e243623edf3e15bd25237de124549f390e3b47ceca3f77b315e6811",
+        "5c97a210914342c49812f18d5fd42d5b60d8985dd45088f9ad6d0503cf0c94bd"
+        "a6da7274ff3b42028625add7c4f5df0134d57eb82b6f134b790d49d67379e40f",
+        "26b6d98f328a39321ff920228b8625eee0037a09332d68cd783841fb4b4e8fb4",
+        false
+    },
+    { /* hash bit flipped */
+        "4e09dfe87e243623edf3e15bd25237de124549f390e3b47ceca3f77b315e6811",
+        "5c97a210914342c49812f18d5fd42d5b60d8985dd45088f9ad6d0503cf0c94bd"
+        "a6da7274ff3b42020625add7c4f5df0134d57eb82b6f134b790d49d67379e40f",
+        "26b6d98f328a39321ff920228b8625eee0037a09332d68cd783841fb4b4e8fb0",
+        false
+    },
+    { /* S + L (non-canonical) */
+        "4e09dfe87e243623edf3e15bd25237de124549f390e3b47ceca3f77b315e6811",
+        "5c97a210914342c49812f18d5fd42d5b60d8985dd45088f9ad6d0503cf0c94bd"
+        "93ae68d1199f545adcc1a47aa3efbe1634d57eb82b6f134b790d49d67379e41f",
+        "26b6d98f328a39321ff920228b8625eee0037a09332d68cd783841fb4b4e8fb4",
+        false
+    },
+    { /* S = L with the identity as key and R: S*B = R + h*A holds, so
+       * only the S < L check can reject it */
+        "0100000000000000000000000000000000000000000000000000000000000000",
+        "0100000000000000000000000000000000000000000000000000000000000000"
+        "edd3f55c1a631258d69cf7a2def9de1400000000000000000000000000000010",
+        "26b6d98f328a39321ff920228b8625eee0037a09332d68cd783841fb4b4e8fb4",
+        false
+    },
+    { /* wrong public key */
+        "2c7136131a2a250c82c43ca826ae45f866b3f6ba87fdf7a462dd643f1b605d04",
+        "5c97a210914342c49812f18d5fd42d5b60d8985dd45088f9ad6d0503cf0c94bd"
+        "a6da7274ff3b42020625add7c4f5df0134d57eb82b6f134b790d49d67379e40f",
+        "26b6d98f328a39321ff920228b8625eee0037a09332d68cd783841fb4b4e8fb4",
+        false
+    },
+    { /* valid */
+        "61f6abf3b4c00fc0147845d60047f7fb68148bd5d437a1c6b3ee16299eafc0fe",
+        "54b9b5b453d4a632e7ff03cc580f31df170e2d8cb1b3d4dae335c1b52bf00597"
+        "890c408c2b96b72f681184a2645e700128136affcb558ca1dd59e78426e3260c",
+        "d7ddd4463d218c68b753516988317007b56cf85fb64c73efd3ab07ba8b10b92a",
+        true
+    },
+    { /* R bit flipped */
+        "61f6abf3b4c00fc0147845d60047f7fb68148bd5d437a1c6b3ee16299eafc0fe",
+        "54b9b5b453d5a632e7ff03cc580f31df170e2d8cb1b3d4dae335c1b52bf00597"
+        "890c408c2b96b72f681184a2645e700128136affcb558ca1dd59e78426e3260c",
+        "d7ddd4463d218c68b753516988317007b56cf85fb64c73efd3ab07ba8b10b92a",
+        false
+    },
+    { /* S bit flipped */
+        "61f6abf3b4c00fc0147845d60047f7fb68148bd5d437a1c6b3ee16299eafc0fe",
+        "54b9b5b453d4a632e7ff03cc580f31df170e2d8cb1b3d4dae335c1b52bf00597"
+        "890c408c2b96b72f689184a2645e700128136affcb558ca1dd59e78426e3260c",
+        "d7ddd4463d218c68b753516988317007b56cf85fb64c73efd3ab07ba8b10b92a",
+        false
+    },
+    { /* hash bit flipped */
+        "61f6abf3b4c00fc0147845d60047f7fb68148bd5d437a1c6b3ee16299eafc0fe",
+        "54b9b5b453d4a632e7ff03cc580f31df170e2d8cb1b3d4dae335c1b52bf00597"
+        "890c408c2b96b72f681184a2645e700128136affcb558ca1dd59e78426e3260c",
+        "d7ddd4463d218c68b753516988317007b56cf85fb64c73efd3ab07ba8b10bd2a",
+        false
+    },
+    { /* S + L (non-canonical) */
+        "61f6abf3b4c00fc0147845d60047f7fb68148bd5d437a1c6b3ee16299eafc0fe",
+        "54b9b5b453d4a632e7ff03cc580f31df170e2d8cb1b3d4dae335c1b52bf00597"
+        "76e035e945f9c9873eae7b4543584f1628136affcb558ca1dd59e78426e3261c",
+        "d7ddd4463d218c68b753516988317007b56cf85fb64c73efd3ab07ba8b10b92a",
+        false
+    },
+    { /* wrong public key */
+        "84f1ed2d46e151403980fec4badc301847c91c36d77968a2652517a9d65180ce",
+        "54b9b5b453d4a632e7ff03cc580f31df170e2d8cb1b3d4dae335c1b52bf00597"
+        "890c408c2b96b72f681184a2645e700128136affcb558ca1dd59e78426e3260c",
+        "d7ddd4463d218c68b753516988317007b56cf85fb64c73efd3ab07ba8b10b92a",
+        false
+    },
+    { /* valid */
+        "94efff40da86d3ff59681960a75621a8c6aeee4a3aab80a3e20fe6cf742f267d",
+        "49d28e098346a73002ff887ac434299dc9acc33555629d6383ab1627dddf83ed"
+        "a477a7f8daa19603e30be93e853b0bb57b5f84bf308895a6df871a0406f74c00",
+        "6ac343d2a7b23c12ee97b2a51b7be83ecb6cbb32b5a20d138be862c1f67447ce",
+        true
+    },
+    { /* valid */
+        "f3830894cdfeda0e8bdd3cc79752045d3f64e9d0647825e62bbadaef6b237e27",
+        "bf743e5d72e54e05cac5cfc756f3f1b6d039c4daac0fcd8d090c3aaea52c66f4"
+        "1908049669a8465d7dae15208ede8da01a8a1c9a40d64face590a7662e936002",
+        "a5cbc88a7e8a81e7df4224f2b23145d1b05b2129e1d60fa67d01a0ee6743dd14",
+        true
+    },
+    { /* valid */
+        "0cd1cf0c26b72f7d5741bac88925a11fb94e814930112ed1801e638538ab0314",
+        "d0cbd9f15d633f12efe4f30c6cf96b413b9d2df25a9b6efad6451933dbf8a825"
+        "20f555da0f47c8c33b3c3e43f235b367a583983bccedcf62dfe12727609e4b06",
+        "2ecbf6c5aad616070eb672bbd089d15cfb7cb1b4baa31e8ddd6258db072a454b",
+        true
+    },
+    { /* valid */
+        "30bd1113aac4eec5073185329836a114451596090bd5e12c9df79bdbaf489e62",
+        "1538824fda1ba59044605d203288cb87510db6fc16226f051301735d217cedbb"
+        "b956514078fed4557f6359f09889aa4d5056d361b72bb8db4de1bc7d40e82b01",
+        "c8b10f4359b4d6c3f629b634f620cdcbbd0b0f1280616be42740ce253c456f6c",
+        true
+    },
+    { /* valid */
+        "53fd3230cde86b3cc2f9dc749de65c8c4e014460974c986ebe120bc0323cf837",
+        "3c4ec0efb9c3a2d56302593c53a83f1e6ff25d4b10bf732e13ed2af729c17ba6"
+        "ae1831451f3c1ed10549afd5d0c28e65d71f31e09c030a76ec3f34505ce46801",
+        "2d1aabefc5b925adfb9a61c8dc563c42055330cb59d06cf45f9435c67f2a5c5b",
+        true
+    },
+    { /* valid */
+        "a94f6edb527cc189e45899b6f0bc8982751e7e2e56db0d949df9757b521cf208",
+        "88a8cd07e688e98f27c1aa8de95ca3018eb958d7e9f533df8fb9ce1511d4aeda"
+        "7b77da81a778b79344a2ee135ab728d8ab928abe76e8cb9278a2ef85ae16f609",
+        "e3ff697de3aef5449899e6254436ac282854bcce22d6bf0672c20ce350ad3670",
+        true
+    },
+    { /* public key not on the curve */
+        "0200000000000000000000000000000000000000000000000000000000000000",
+        "5c97a210914342c49812f18d5fd42d5b60d8985dd45088f9ad6d0503cf0c94bd"
+        "a6da7274ff3b42020625add7c4f5df0134d57eb82b6f134b790d49d67379e40f",
+        "26b6d98f328a39321ff920228b8625eee0037a09332d68cd783841fb4b4e8fb4",
+        false
+    },
+};
+
+static void
+from_hex(uint8_t *out, const char *hex, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        unsigned v;
+        sscanf(&hex[i * 2], "%2x", &v);
+        out[i] = (uint8_t)v;
+    }
+}
+
+int
+main(void)
+{
+    size_t count = sizeof(vectors) / sizeof(vectors[0]);
+    size_t failed = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t signature[64];
+        uint8_t hash[32];
+        from_hex(ZK_PUBKEY, vectors[i].pubkey, 32);
+        from_hex(signature, vectors[i].signature, 64);
+        from_hex(hash, vectors[i].hash, 32);
+        if (crypto_ed25519_verify(signature, hash) != vectors[i].valid) {
+            printf("vector %zu: expected %s\n", i,
+                   vectors[i].valid ? "valid" : "invalid");
+            failed++;
+        }
+    }
+    printf("ed25519: %zu/%zu vectors passed\n", count - failed, count);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,241 @@
+/*
+ * test_fec.c - Host test for the Reed–Solomon link layer
+ *
+ * Frames are built with an encoder equivalent to tools/rs_fec.py and
+ * fed to fec_process_char() one byte at a time.  The protocol parser
+ * and USB layer are replaced by stubs that record what the decoder
+ * delivers, so each case can check the payload stream and the number
+ * of ERR FEC replies.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fec.c"
+
+static uint8_t delivered[4096];
+static size_t  delivered_len;
+static int     err_replies;
+
+void
+protocol_process_char(uint8_t c)
+{
+    delivered[delivered_len++] = c;
+}
+
+size_t
+protocol_process(const uint8_t *data, size_t len)
+{
+    memcpy(&delivered[delivered_len], data, len);
+    delivered_len += len;
+    return len;
+}
+
+void
+protocol_dispatch(void)
+{
+}
+
+uint32_t
+crypto_crc32_update(uint32_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t n = 0; n < len; n++) {
+        crc ^= data[n];
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ ((crc & 1u) ? 0xEDB88320UL : 0u);
+        }
+    }
+    return crc;
+}
+
+void
+usb_cdc_write(const uint8_t *data, size_t len)
+{
+    if (len == 8u && memcmp(data, "ERR FEC\n", 8) == 0) {
+        err_replies++;
+    }
+}
+
+#define FRAME_SIZE (FEC_SYNC_SIZE + FEC_CODEWORD_SIZE)
+#define FRAMES     3u
+
+/* Systematic encoder: parity is the remainder of data * x^32 by g(x). */
+static void
+encode_frame(uint8_t *out, const uint8_t *payload, size_t len)
+{
+    static const uint8_t sync[FEC_SYNC_SIZE] = FEC_SYNC_WORD;
+    uint8_t gen[FEC_PARITY_SIZE + 1] = { 1 };
+
+    for (size_t j = 0; j < FEC_PARITY_SIZE; j++) {
+        for (size_t i = j + 1u; i > 0; i--) {
+            gen[i] ^= gf_mul(gen[i - 1u], gf_exp[j]);
+        }
+    }
+
+    memcpy(out, sync, FEC_SYNC_SIZE);
+    uint8_t *cw = &out[FEC_SYNC_SIZE];
+    memset(cw, 0, FEC_CODEWORD_SIZE);
+    cw[0] = (uint8_t)len;
+    memcpy(&cw[1], payload, len);
+    uint32_t crc = crypto_crc32_update(0xFFFFFFFFUL, cw, FEC_CRC_OFFSET) ^
+                   0xFFFFFFFFUL;
+    for (size_t i = 0; i < 4u; i++) {
+        cw[FEC_CRC_OFFSET + i] = (uint8_t)(crc >> (8u * i));
+    }
+
+    uint8_t *rem = &cw[FEC_DATA_SIZE];
+    for (size_t i = 0; i < FEC_DATA_SIZE; i++) {
+        uint8_t fb = cw[i] ^ rem[0];
+        memmove(rem, &rem[1], FEC_PARITY_SIZE - 1u);
+        rem[FEC_PARITY_SIZE - 1u] = 0;
+        for (size_t k = 0; k < FEC_PARITY_SIZE; k++) {
+            rem[k] ^= gf_mul(fb, gen[k + 1u]);
+        }
+    }
+}
+
+static uint8_t payload[FRAMES][FEC_MAX_PAYLOAD];
+static uint8_t stream[FRAMES * FRAME_SIZE + 1u];
+
+static void
+build_stream(void)
+{
+    for (size_t f = 0; f < FRAMES; f++) {
+        for (size_t i = 0; i < FEC_MAX_PAYLOAD; i++) {
+            payload[f][i] = (uint8_t)(rand() & 0xFF);
+        }
+        encode_frame(&stream[f * FRAME_SIZE], payload[f], FEC_MAX_PAYLOAD);
+    }
+}
+
+/* Feed `stream` with byte `pos` dropped (slip < 0), repeated
+ * (slip > 0) or untouched (slip == 0). */
+static void
+feed(long pos, int slip)
+{
+    delivered_len = 0;
+    err_replies = 0;
+    fec_enable(true);
+
+    for (long i = 0; i < (long)(FRAMES * FRAME_SIZE); i++) {
+        if (i == pos && slip < 0) {
+            continue;
+        }
+        fec_process_char(stream[i]);
+        if (i == pos && slip > 0) {
+            fec_process_char(stream[i]);
+        }
+    }
+}
+
+/* Feed `stream` as above and check that exactly the frames in the bit
+ * mask `good` arrive, with `errors` ERR FEC replies. */
+static bool
+run_case(const char *name, long pos, int slip, unsigned good, int errors)
+{
+    feed(pos, slip);
+
+    bool ok = (err_replies == errors);
+    size_t off = 0;
+    for (size_t f = 0; ok && f < FRAMES; f++) {
+        if ((good & (1u << f)) != 0u) {
+            ok = (delivered_len >= off + FEC_MAX_PAYLOAD) &&
+                 memcmp(&delivered[off], payload[f], FEC_MAX_PAYLOAD) == 0;
+            off += FEC_MAX_PAYLOAD;
+        }
+    }
+    ok = ok && (delivered_len == off);
+    if (!ok) {
+        printf("%s: %zu bytes delivered, %d ERR FEC\n", name, delivered_len,
+               err_replies);
+    }
+    return ok;
+}
+
+/* True when the parser received only whole, intact payloads. */
+static bool
+no_garbage(void)
+{
+    if ((delivered_len % FEC_MAX_PAYLOAD) != 0u) {
+        return false;
+    }
+    for (size_t off = 0; off < delivered_len; off += FEC_MAX_PAYLOAD) {
+        bool known = false;
+        for (size_t f = 0; f < FRAMES; f++) {
+            known = known ||
+                    memcmp(&delivered[off], payload[f], FEC_MAX_PAYLOAD) == 0;
+        }
+        if (!known) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int
+main(void)
+{
+    int failed = 0;
+    int count = 0;
+
+    fec_init();
+    srand(1);
+    build_stream();
+
+    count++;
+    failed += !run_case("clean", -1, 0, 0x7u, 0);
+
+    /* 16 byte errors in the first codeword are corrected */
+    for (size_t i = 0; i < 16u; i++) {
+        stream[FEC_SYNC_SIZE + i * 15u] ^= 0x5Au;
+    }
+    count++;
+    failed += !run_case("16 errors", -1, 0, 0x7u, 0);
+    count++;
+    failed += (stats.corrected_bytes != 16u);
+    build_stream();
+
+    /* A lost or repeated byte costs only the frames it touches, and is
+     * reported once */
+    count++;
+    failed += !run_case("dropped payload byte", FEC_SYNC_SIZE + 100, -1, 0x6u, 1);
+    count++;
+    failed += !run_case("repeated payload byte", FEC_SYNC_SIZE + 100, 1, 0x6u, 1);
+    count++;
+    failed += !run_case("dropped sync byte", 2, -1, 0x6u, 1);
+    /* The first frame absorbs a sync byte as a correctable error, and
+     * the second frame's sync word is cut short */
+    count++;
+    failed += !run_case("dropped parity byte", FRAME_SIZE - 1, -1, 0x5u, 1);
+
+    /* Slips near the start of a codeword leave it close to a rotated
+     * codeword, which the decoder may "correct"; the CRC must catch it */
+    for (long off = 1; off <= 16; off++) {
+        char name[40];
+        snprintf(name, sizeof(name), "dropped byte at offset %ld", off);
+        count++;
+        failed += !run_case(name, FEC_SYNC_SIZE + off, -1, 0x6u, 1);
+        snprintf(name, sizeof(name), "repeated byte at offset %ld", off);
+        count++;
+        failed += !run_case(name, FEC_SYNC_SIZE + off, 1, 0x6u, 1);
+    }
+
+    /* No single slip anywhere in the stream delivers garbage */
+    count++;
+    for (long pos = 0; pos < (long)(FRAMES * FRAME_SIZE); pos++) {
+        bool ok = true;
+        for (int slip = -1; slip <= 1; slip += 2) {
+            feed(pos, slip);
+            ok = ok && no_garbage();
+        }
+        if (!ok) {
+            printf("slip at %ld: garbage delivered\n", pos);
+            failed++;
+            break;
+        }
+    }
+
+    printf("fec: %d/%d cases passed\n", count - failed, count);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Generate the Ed25519 base point table of BOOT_FAST builds.
+
+Prints the ED25519_BASE_TABLE initialiser used by crypto_ops.c: the
+multiples 1*B .. 15*B of the Ed25519 base point in precomputed affine
+form (y + x, y - x, 2*d*x*y), each coordinate as five 51-bit limbs
+(the fe51 representation).  The verifier adds entry n-1 for a scalar
+nibble n, so 4-bit windows of S*B cost one mixed addition each.
+
+Usage:
+    ed25519_table.py > table.txt
+"""
+
+P = 2**255 - 19
+D = (-121665 * pow(121666, P - 2, P)) % P
+WINDOW = 16
+
+
+def _base_point():
+    y = 4 * pow(5, P - 2, P) % P
+    xx = (y * y - 1) * pow(D * y * y + 1, P - 2, P) % P
+    x = pow(xx, (P + 3) // 8, P)
+    if (x * x - xx) % P != 0:
+        x = x * pow(2, (P - 1) // 4, P) % P
+    if x & 1:
+        x = P - x
+    return x, y
+
+
+def _add(p, q):
+    (x1, y1), (x2, y2) = p, q
+    t = D * x1 * x2 * y1 * y2 % P
+    x3 = (x1 * y2 + y1 * x2) * pow(1 + t, P - 2, P) % P
+    y3 = (y1 * y2 + x1 * x2) * pow(1 - t, P - 2, P) % P
+    return x3, y3
+
+
+def _limbs(v):
+    return [(v >> (51 * i)) & ((1 << 51) - 1) for i in range(5)]
+
+
+def _fe(v):
+    limbs = ["%dULL" % limb for limb in _limbs(v)]
+    return ("{{ " + ", ".join(limbs[:3]) + ",\n" +
+            "           " + ", ".join(limbs[3:]) + " }}")
+
+
+def main():
+    base = _base_point()
+    point = base
+    print("static const ge_precomp ED25519_BASE_TABLE[%d] = {" % (WINDOW - 1))
+    for n in range(1, WINDOW):
+        x, y = point
+        entries = ((y + x) % P, (y - x) % P, 2 * D * x * y % P)
+        print("    { /* %d*B */" % n)
+        for i, v in enumerate(entries):
+            print("        %s%s" % (_fe(v), "," if i < 2 else ""))
+        print("    }%s" % ("," if n < WINDOW - 1 else ""))
+        point = _add(point, base)
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,282 @@
+#!/usr/bin/env python3
+"""Flash a packaged application image through ZeroBootloader over USB.
+
+The bootloader's CDC data interface is driven directly with libusb (the
+python-libusb1 package) instead of through the serial driver, using
+the asynchronous API:
+
+  * up to --depth bulk OUT transfers of up to --chunk bytes (a
+    multiple of the 256-byte flash row) are kept submitted, so the
+    device always finds the next packet waiting when it re-arms its OUT
+    bank;
+  * a few bulk IN transfers stay submitted to collect replies;
+  * a single event loop (libusb_handle_events) completes both, refills
+    the OUT queue and splits replies into lines.
+
+WRITE blocks are sent from the manifest written by package_image.py
+(run it with --key so the manifest carries the signature for DONE).  Up
+to --depth blocks may be waiting for their OK WRITE at any time.  The
+device programs and hashes a block even when its CRC fails, so any
+ERR CRC restarts the whole transfer from ERASE APP (up to --retries
+times).
+
+Usage:
+    package_image.py --key seed.hex image.bin
+    flash_image.py [--depth N] [--chunk BYTES] image.bin
+"""
+
+import argparse
+import collections
+import hashlib
+import json
+import sys
+import time
+
+ROW_SIZE = 256
+VENDOR_ID = 0x2341
+PRODUCT_ID = 0x004D
+CDC_DATA_CLASS = 0x0A
+IN_TRANSFERS = 2
+IN_SIZE = 512
+OUT_TIMEOUT_MS = 5000
+REPLY_TIMEOUT = 5.0
+ERASE_TIMEOUT = 30.0
+
+
+class FlashError(Exception):
+    pass
+
+
+class AsyncLink:
+    """Byte stream over a pair of bulk endpoints, driven by libusb events.
+
+    send() only queues data; transfers are submitted from poll() and from
+    the completion callbacks, so nothing blocks while the device NAKs.
+    """
+
+    def __init__(self, usb1, context, handle, ep_out, ep_in, chunk, depth):
+        self._usb1 = usb1
+        self._context = context
+        self._ep_out = ep_out
+        self._chunk = chunk
+        self._queue = collections.deque()
+        self._queued = 0
+        self._free = [handle.getTransfer() for _ in range(depth)]
+        self._busy = set()
+        self._reader = [handle.getTransfer() for _ in range(IN_TRANSFERS)]
+        self._rx = bytearray()
+        self._lines = collections.deque()
+        self.error = None
+        for transfer in self._reader:
+            transfer.setBulk(ep_in, IN_SIZE, callback=self._in_done)
+            transfer.submit()
+
+    def send(self, data):
+        self._queue.append(memoryview(data))
+        self._queued += len(data)
+        self._refill()
+
+    def _take(self):
+        """Pop the next chunk from the queue, across queued pieces."""
+        size = min(self._chunk, self._queued)
+        out = bytearray()
+        while len(out) < size:
+            piece = self._queue[0]
+            need = size - len(out)
+            out += piece[:need]
+            if len(piece) > need:
+                self._queue[0] = piece[need:]
+            else:
+                self._queue.popleft()
+        self._queued -= size
+        return bytes(out)
+
+    def _refill(self):
+        while self._free and self._queued and self.error is None:
+            transfer = self._free.pop()
+            transfer.setBulk(self._ep_out, self._take(), callback=self._out_done,
+                             timeout=OUT_TIMEOUT_MS)
+            transfer.submit()
+            self._busy.add(transfer)
+
+    def _out_done(self, transfer):
+        self._busy.discard(transfer)
+        self._free.append(transfer)
+        status = transfer.getStatus()
+        if status != self._usb1.TRANSFER_COMPLETED:
+            if status != self._usb1.TRANSFER_CANCELLED and self.error is None:
+                self.error = "bulk OUT failed (status %d)" % status
+            return
+        self._refill()
+
+    def _in_done(self, transfer):
+        status = transfer.getStatus()
+        if status == self._usb1.TRANSFER_COMPLETED:
+            self._rx += transfer.getBuffer()[:transfer.getActualLength()]
+            while b"\n" in self._rx:
+                line, _, rest = self._rx.partition(b"\n")
+                self._lines.append(line.decode("ascii", "replace").strip())
+                self._rx = bytearray(rest)
+        elif status != self._usb1.TRANSFER_TIMED_OUT:
+            if status != self._usb1.TRANSFER_CANCELLED and self.error is None:
+                self.error = "bulk IN failed (status %d)" % status
+            return
+        transfer.submit()
+
+    def poll(self, timeout):
+        self._context.handleEventsTimeout(tv=timeout)
+        if self.error is not None:
+            raise FlashError(self.error)
+
+    def readline(self, timeout=REPLY_TIMEOUT):
+        deadline = time.monotonic() + timeout
+        while not self._lines:
+            left = deadline - time.monotonic()
+            if left <= 0:
+                raise FlashError("no reply from the device")
+            self.poll(min(left, 0.1))
+        return self._lines.popleft()
+
+    def close(self):
+        for transfer in list(self._busy) + self._reader:
+            if transfer.isSubmitted():
+                try:
+                    transfer.cancel()
+                except self._usb1.USBError:
+                    pass
+        deadline = time.monotonic() + 1.0
+        while time.monotonic() < deadline and \
+                any(t.isSubmitted() for t in list(self._busy) + self._reader):
+            self._context.handleEventsTimeout(tv=0.05)
+
+
+def _command(link, line, expect, timeout=REPLY_TIMEOUT):
+    link.send((line + "\n").encode("ascii"))
+    reply = link.readline(timeout)
+    if not reply.startswith(expect):
+        raise FlashError("%s: %s" % (line.split()[0], reply))
+    return reply
+
+
+def _write_blocks(link, image, base, blocks, window):
+    """Stream all WRITE blocks, keeping up to `window` unacknowledged.
+    Returns the number of blocks answered with ERR CRC."""
+    sent = answered = failed = 0
+    while answered < len(blocks):
+        while sent < len(blocks) and sent - answered < window:
+            block = blocks[sent]
+            addr = int(block["addr"], 16)
+            data = image[addr - base:addr - base + block["len"]]
+            link.send(b"WRITE 0x%08x %d %s\n" % (addr, len(data), block["crc"].encode()))
+            link.send(data)
+            sent += 1
+        reply = link.readline()
+        answered += 1
+        if reply == "ERR CRC":
+            failed += 1
+            # Let the blocks already in flight finish, then start over.
+            window = 0
+        elif reply != "OK WRITE":
+            raise FlashError("WRITE %s: %s" % (blocks[answered - 1]["addr"], reply))
+        if failed and sent == answered:
+            break
+    return failed
+
+
+def flash(link, image, manifest, window, retries):
+    base = int(manifest["base"], 16)
+    blocks = manifest["blocks"]
+    _command(link, "HELLO", "OK BOOT")
+    for attempt in range(retries + 1):
+        _command(link, "ERASE APP", "OK ERASE", ERASE_TIMEOUT)
+        start = time.monotonic()
+        failed = _write_blocks(link, image, base, blocks, window)
+        if failed == 0:
+            _command(link, "SYNC", "OK SYNC")
+            elapsed = time.monotonic() - start
+            print("wrote %d bytes in %.2f s (%.1f KiB/s)"
+                  % (len(image), elapsed, len(image) / 1024.0 / max(elapsed, 1e-6)))
+            break
+        print("attempt %d: %d block(s) failed CRC, restarting" % (attempt + 1, failed),
+              file=sys.stderr)
+    else:
+        raise FlashError("CRC errors persisted after %d attempts" % (retries + 1))
+    _command(link, "DONE " + manifest["signature"], "OK DONE")
+
+
+def _open(usb1, context, vid, pid):
+    handle = context.openByVendorIDAndProductID(vid, pid, skip_on_error=True)
+    if handle is None:
+        raise FlashError("no device %04x:%04x" % (vid, pid))
+    for setting in handle.getDevice().iterSettings():
+        if setting.getClass() != CDC_DATA_CLASS:
+            continue
+        ep_out = ep_in = None
+        for endpoint in setting:
+            if endpoint.getAttributes() & 3 != 2:
+                continue
+            if endpoint.getAddress() & 0x80:
+                ep_in = endpoint.getAddress()
+            else:
+                ep_out = endpoint.getAddress()
+        handle.setAutoDetachKernelDriver(True)
+        handle.claimInterface(setting.getNumber())
+        return handle, setting.getNumber(), ep_out, ep_in
+    raise FlashError("device has no CDC data interface")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("image")
+    ap.add_argument("--manifest", help="package_image.py output (default <image>.json)")
+    ap.add_argument("--vid", type=lambda v: int(v, 0), default=VENDOR_ID)
+    ap.add_argument("--pid", type=lambda v: int(v, 0), default=PRODUCT_ID)
+    ap.add_argument("--depth", type=int, default=8,
+                    help="bulk OUT transfers in flight, and WRITE blocks awaiting a reply")
+    ap.add_argument("--chunk", type=int, default=4 * ROW_SIZE,
+                    help="bytes per bulk OUT transfer (multiple of %d)" % ROW_SIZE)
+    ap.add_argument("--retries", type=int, default=2)
+    args = ap.parse_args()
+    if args.chunk <= 0 or args.chunk % ROW_SIZE or args.depth <= 0:
+        ap.error("--chunk must be a positive multiple of %d and --depth positive" % ROW_SIZE)
+
+    with open(args.image, "rb") as fh:
+        image = fh.read()
+    with open(args.manifest or args.image + ".json", encoding="ascii") as fh:
+        manifest = json.load(fh)
+    if manifest["digest"] != hashlib.sha256(image).hexdigest():
+        sys.exit("manifest does not match %s; run package_image.py again" % args.image)
+    if "signature" not in manifest:
+        sys.exit("manifest is unsigned; run package_image.py with --key")
+
+    try:
+        import usb1
+    except ImportError:
+        sys.exit("flash_image.py needs the 'libusb1' package")
+
+    with usb1.USBContext() as context:
+        handle = None
+        link = None
+        try:
+            handle, interface, ep_out, ep_in = _open(usb1, context, args.vid, args.pid)
+            link = AsyncLink(usb1, context, handle, ep_out, ep_in, args.chunk, args.depth)
+            flash(link, image, manifest, args.depth, args.retries)
+            print("OK DONE")
+        except FlashError as exc:
+            sys.exit("error: %s" % exc)
+        finally:
+            # After OK DONE the device jumps to the application and drops
+            # off the bus; errors while tearing down are expected then.
+            if link is not None:
+                link.close()
+            if handle is not None:
+                try:
+                    handle.releaseInterface(interface)
+                except usb1.USBError:
+                    pass
+                handle.close()
+
+
+if __name__ == "__main__":
+    main()
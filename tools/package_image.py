@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Package application images for ZeroBootloader.
+
+For every input image (a raw .bin linked at APP_START_ADDRESS) this
+writes a JSON manifest next to it (<image>.json) containing:
+
+  * rows          CRC32 of every 256-byte flash row, 0xFF padded.  These
+                  match the bootloader's `CRC <addr>` replies.
+  * blocks        the WRITE plan (address, length, CRC32) for the image.
+  * digest        SHA-256 of the image bytes as sent with WRITE.  This is
+                  the message signed for `DONE`.
+  * region_digest SHA-256 of the whole application region as flashed.
+                  This matches the bootloader's `HASH APP` reply.
+                  CRC and HASH APP need a bootloader built with
+                  APP_HASH=1, the default above 8 KB.
+  * chunks / tree_root
+                  per-chunk SHA-256 hashes and the SHA-256 over their
+                  concatenation.
+  * signature     Ed25519 signature of `digest` when --key is given.
+
+All hashing is done by zlib and hashlib.  Both release the GIL and use
+the fastest kernels of the underlying native libraries (e.g. SHA-NI in
+OpenSSL and folded CRC32 in zlib builds that have it), with portable
+fallbacks otherwise.  Images, and the chunks inside each image, are
+spread over a thread pool, so a batch scales across cores.
+
+Images for a bootloader built with another BOOT_SIZE (e.g. `make FAST=1`,
+16 KiB) are linked higher; pass the same size with --boot-size.
+
+Usage:
+    package_image.py [--key seed.hex] [--jobs N] [--boot-size KB] image.bin [image.bin ...]
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import sys
+import zlib
+from concurrent.futures import ThreadPoolExecutor
+
+APP_START_ADDRESS = 0x00002000
+FLASH_SIZE = 256 * 1024
+ROW_SIZE = 256
+BLOCK_SIZE = 4 * ROW_SIZE
+CHUNK_SIZE = 4096
+
+
+def _row_crcs(region, start, end):
+    view = memoryview(region)
+    return [zlib.crc32(view[off:off + ROW_SIZE]) for off in range(start, end, ROW_SIZE)]
+
+
+def _sha256(data):
+    return hashlib.sha256(data).digest()
+
+
+def _load_signer(path):
+    if path is None:
+        return None
+    try:
+        from cryptography.hazmat.primitives.asymmetric.ed25519 import Ed25519PrivateKey
+    except ImportError:
+        sys.exit("--key needs the 'cryptography' package")
+    with open(path, encoding="ascii") as fh:
+        seed = bytes.fromhex(fh.read().strip())
+    return Ed25519PrivateKey.from_private_bytes(seed)
+
+
+def package(path, pool, signer, base, flash_size):
+    with open(path, "rb") as fh:
+        image = fh.read()
+    if len(image) > flash_size - base:
+        raise ValueError("%s does not fit the application region" % path)
+
+    region = image + b"\xff" * (flash_size - base - len(image))
+    view = memoryview(region)
+
+    # Per-row CRCs, split into one job per chunk so large images use
+    # every worker.
+    crc_jobs = [pool.submit(_row_crcs, region, off, min(off + CHUNK_SIZE, len(region)))
+                for off in range(0, len(region), CHUNK_SIZE)]
+    used = len(image)
+    chunk_jobs = [pool.submit(_sha256, view[off:off + CHUNK_SIZE])
+                  for off in range(0, used, CHUNK_SIZE)]
+    digest_job = pool.submit(_sha256, image)
+    region_job = pool.submit(_sha256, region)
+
+    rows = [crc for job in crc_jobs for crc in job.result()]
+    chunks = [job.result() for job in chunk_jobs]
+    digest = digest_job.result()
+
+    blocks = []
+    for off in range(0, used, BLOCK_SIZE):
+        data = view[off:min(off + BLOCK_SIZE, used)]
+        blocks.append({"addr": "0x%08x" % (base + off), "len": len(data),
+                       "crc": "0x%08x" % zlib.crc32(data)})
+
+    manifest = {
+        "image": os.path.basename(path),
+        "base": "0x%08x" % base,
+        "length": used,
+        "rows": ["%08x" % crc for crc in rows],
+        "blocks": blocks,
+        "digest": digest.hex(),
+        "region_digest": region_job.result().hex(),
+        "chunk_size": CHUNK_SIZE,
+        "chunks": [c.hex() for c in chunks],
+        "tree_root": _sha256(b"".join(chunks)).hex(),
+    }
+    if signer is not None:
+        manifest["signature"] = signer.sign(digest).hex()
+
+    with open(path + ".json", "w", encoding="ascii") as fh:
+        json.dump(manifest, fh, indent=1)
+    return path + ".json"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("images", nargs="+")
+    ap.add_argument("--key", help="file holding the 32-byte Ed25519 seed in hex")
+    ap.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    ap.add_argument("--boot-size", type=int, choices=(8, 16, 32),
+                    help="bootloader region in KiB (BOOT_SIZE); sets --base")
+    ap.add_argument("--base", type=lambda v: int(v, 0), default=APP_START_ADDRESS)
+    ap.add_argument("--flash-size", type=lambda v: int(v, 0), default=FLASH_SIZE)
+    args = ap.parse_args()
+    if args.boot_size is not None:
+        args.base = args.boot_size * 1024
+
+    signer = _load_signer(args.key)
+    # Images are driven from a separate small pool so their chunk jobs
+    # never wait behind whole-image jobs for a worker.
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool, \
+            ThreadPoolExecutor(max_workers=min(args.jobs, len(args.images))) as outer:
+        jobs = [outer.submit(package, path, pool, signer, args.base, args.flash_size)
+                for path in args.images]
+        for job in jobs:
+            print(job.result())
+
+
+if __name__ == "__main__":
+    main()
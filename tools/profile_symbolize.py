@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Symbolise a ZeroBootloader `PROF DUMP` histogram into a flat profile.
+
+The dump is the text the bootloader prints in reply to `PROF DUMP`:
+
+    PROF <bucket_shift> <samples> <ram> <other>
+    <address> <count>
+    ...
+    OK PROF
+
+Symbols come either from the linker map (samd21_bootloader.map, which
+lists every -ffunction-sections input section, statics included) or from
+the ELF via `arm-none-eabi-nm`.  A bucket that straddles several
+functions has its samples split in proportion to the bytes each function
+covers inside the bucket.  The bootloader charges samples in code copied
+to SRAM (.ramfunc) to that code's flash load address, so those symbols
+are moved to their load addresses here as well.
+
+Usage:
+    profile_symbolize.py DUMP (samd21_bootloader.map | samd21_bootloader.elf)
+"""
+
+import re
+import subprocess
+import sys
+from collections import defaultdict
+
+NM = "arm-none-eabi-nm"
+OBJDUMP = "arm-none-eabi-objdump"
+
+_SECTION_RE = re.compile(r"^ \.(?:text|ramfunc)\.(\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+\S+)?\s*$")
+_CONT_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+\S+\s*$")
+_RAMFUNC_MAP_RE = re.compile(r"^\.ramfunc\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+load address 0x([0-9a-fA-F]+)")
+
+
+def to_load_addresses(syms, ramfunc):
+    """Move symbols inside the .ramfunc run range to its load range."""
+    if ramfunc is None:
+        return syms
+    vma, size, lma = ramfunc
+    return [(start - vma + lma if vma <= start < vma + size else start, length, name)
+            for start, length, name in syms]
+
+
+def symbols_from_map(path):
+    """Return [(start, size, name)] for the function sections in a map file."""
+    syms = []
+    pending = None
+    ramfunc = None
+    with open(path, encoding="utf-8", errors="replace") as fh:
+        for line in fh:
+            m = _RAMFUNC_MAP_RE.match(line)
+            if m:
+                ramfunc = tuple(int(g, 16) for g in m.groups())
+                continue
+            if pending is not None:
+                m = _CONT_RE.match(line)
+                if m:
+                    syms.append((int(m.group(1), 16), int(m.group(2), 16), pending))
+                pending = None
+                continue
+            m = _SECTION_RE.match(line)
+            if not m:
+                continue
+            if m.group(2) is None:
+                # Long section names wrap the address onto the next line.
+                pending = m.group(1)
+            else:
+                syms.append((int(m.group(2), 16), int(m.group(3), 16), m.group(1)))
+    return to_load_addresses([s for s in syms if s[1] > 0], ramfunc)
+
+
+def symbols_from_elf(path):
+    """Return [(start, size, name)] for the text symbols of an ELF file."""
+    out = subprocess.run([NM, "-S", "-n", "--defined-only", path],
+                         check=True, capture_output=True, text=True).stdout
+    syms = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in "tTwW":
+            # Thumb function symbols have bit 0 set.
+            syms.append((int(parts[0], 16) & ~1, int(parts[1], 16), parts[3]))
+
+    # objdump -h: "idx name size vma lma offset align"
+    ramfunc = None
+    out = subprocess.run([OBJDUMP, "-h", path],
+                         check=True, capture_output=True, text=True).stdout
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 5 and parts[1] == ".ramfunc":
+            ramfunc = (int(parts[3], 16), int(parts[2], 16), int(parts[4], 16))
+    return to_load_addresses(syms, ramfunc)
+
+
+def parse_dump(path):
+    shift = None
+    totals = {}
+    buckets = []
+    with open(path, encoding="utf-8") as fh:
+        for line in fh:
+            parts = line.split()
+            if not parts:
+                continue
+            if parts[0] == "PROF" and len(parts) == 5:
+                shift = int(parts[1])
+                totals = {"samples": int(parts[2]), "ram": int(parts[3]),
+                          "other": int(parts[4])}
+            elif parts[0] == "OK":
+                break
+            elif shift is not None and len(parts) == 2:
+                buckets.append((int(parts[0]), int(parts[1])))
+    if shift is None:
+        sys.exit("no PROF header found in dump")
+    return shift, totals, buckets
+
+
+def attribute(shift, buckets, syms):
+    size = 1 << shift
+    profile = defaultdict(float)
+    for base, count in buckets:
+        end = base + size
+        covered = []
+        for start, length, name in syms:
+            lo = max(base, start)
+            hi = min(end, start + length)
+            if hi > lo:
+                covered.append((hi - lo, name))
+        span = sum(c for c, _ in covered)
+        if span == 0:
+            profile["<unknown 0x%05x>" % base] += count
+            continue
+        for c, name in covered:
+            profile[name] += count * c / span
+    return profile
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.exit(__doc__)
+    shift, totals, buckets = parse_dump(argv[1])
+    if argv[2].endswith(".map"):
+        syms = symbols_from_map(argv[2])
+    else:
+        syms = symbols_from_elf(argv[2])
+
+    profile = attribute(shift, buckets, syms)
+    if totals["ram"]:
+        profile["<sram>"] += totals["ram"]
+    if totals["other"]:
+        profile["<other>"] += totals["other"]
+
+    total = totals["samples"] or 1
+    print("%d samples, %d-byte buckets" % (totals["samples"], 1 << shift))
+    print("%8s %7s  %s" % ("samples", "%", "function"))
+    for name, count in sorted(profile.items(), key=lambda kv: -kv[1]):
+        print("%8.1f %6.2f%%  %s" % (count, 100.0 * count / total, name))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Reed-Solomon framing for the ZeroBootloader FEC link (see fec.h).
+
+Splits a byte stream into RS(255,223) codewords over GF(2^8) with
+polynomial 0x11D and generator roots alpha^0 .. alpha^31, each sent
+after a sync word:
+
+    [1A CF FC 1D][L][payload (L <= 218)][zero padding][CRC32][32 parity]
+
+The CRC32 (zlib, little endian) covers L, the payload and the padding,
+and lets the bootloader reject a slipped frame that decodes as a
+rotated codeword.
+
+Usable as a module (`encode_stream`, `encode_frame`) or as a filter:
+
+    printf 'HELLO\\n' | rs_fec.py > frames.bin
+"""
+
+import sys
+import zlib
+
+CODEWORD = 255
+PARITY = 32
+DATA = CODEWORD - PARITY
+CRC_OFFSET = DATA - 4
+MAX_PAYLOAD = CRC_OFFSET - 1
+SYNC = bytes([0x1A, 0xCF, 0xFC, 0x1D])
+
+_EXP = [0] * 512
+_LOG = [0] * 256
+_x = 1
+for _i in range(255):
+    _EXP[_i] = _x
+    _LOG[_x] = _i
+    _x <<= 1
+    if _x & 0x100:
+        _x ^= 0x11D
+for _i in range(255, 512):
+    _EXP[_i] = _EXP[_i - 255]
+
+
+def _mul(a, b):
+    if a == 0 or b == 0:
+        return 0
+    return _EXP[_LOG[a] + _LOG[b]]
+
+
+def _generator():
+    """g(x) = prod (x - alpha^j), highest-degree coefficient first."""
+    g = [1]
+    for j in range(PARITY):
+        nxt = g + [0]
+        for i, coef in enumerate(g):
+            nxt[i + 1] ^= _mul(coef, _EXP[j])
+        g = nxt
+    return g
+
+
+_GEN = _generator()
+
+
+def encode_frame(payload):
+    """Return the sync word and one 255-byte codeword carrying up to
+    MAX_PAYLOAD bytes."""
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError("payload longer than %d bytes" % MAX_PAYLOAD)
+    data = bytes([len(payload)]) + bytes(payload)
+    data += bytes(CRC_OFFSET - len(data))
+    data += zlib.crc32(data).to_bytes(4, "little")
+    rem = [0] * PARITY
+    for byte in data:
+        fb = byte ^ rem[0]
+        rem = rem[1:] + [0]
+        if fb:
+            for i in range(PARITY):
+                rem[i] ^= _mul(fb, _GEN[i + 1])
+    return SYNC + data + bytes(rem)
+
+
+def encode_stream(data):
+    """Encode an arbitrary byte string as a sequence of codewords."""
+    out = bytearray()
+    for off in range(0, len(data), MAX_PAYLOAD):
+        out += encode_frame(data[off:off + MAX_PAYLOAD])
+    return bytes(out)
+
+
+if __name__ == "__main__":
+    sys.stdout.buffer.write(encode_stream(sys.stdin.buffer.read()))
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Sign a ZeroBootloader RAM applet and print the commands to run it.
+
+The applet is a raw binary linked with tools/applet.ld.  Its signature is
+Ed25519 with the bootloader key over
+
+    SHA-256(b"ZeroBoot applet\\0" + applet)
+
+Output is the two command lines to send, the binary going right after
+the first one:
+
+    APPLET <len> <crc32>
+    RUN <signature_hex> [args]
+
+The bootloader must be built with APPLET=1, the default above 8 KB.
+
+Usage:
+    sign_applet.py --key seed.hex applet.bin [args ...]
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+DOMAIN = b"ZeroBoot applet\0"
+APPLET_ADDRESS = 0x20000000
+APPLET_MAX_SIZE = 4096
+APPLET_MAGIC = 0x5041425A
+
+
+def applet_digest(blob):
+    return hashlib.sha256(DOMAIN + blob).digest()
+
+
+def check(blob):
+    """Mirror the bootloader's checks so a bad build fails here."""
+    if not 8 <= len(blob) <= APPLET_MAX_SIZE:
+        raise ValueError("applet must be 8..%d bytes" % APPLET_MAX_SIZE)
+    magic, entry = struct.unpack_from("<II", blob)
+    if magic != APPLET_MAGIC:
+        raise ValueError("missing applet header (was it linked with applet.ld?)")
+    if not entry & 1 or not APPLET_ADDRESS + 8 <= (entry & ~1) < APPLET_ADDRESS + len(blob):
+        raise ValueError("entry 0x%08x is not Thumb code inside the image" % entry)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--key", required=True, help="file holding the 32-byte Ed25519 seed in hex")
+    ap.add_argument("applet")
+    ap.add_argument("args", nargs="*", help="argument string passed to the applet (not signed)")
+    args = ap.parse_args()
+
+    try:
+        from cryptography.hazmat.primitives.asymmetric.ed25519 import Ed25519PrivateKey
+    except ImportError:
+        sys.exit("needs the 'cryptography' package")
+    with open(args.key, encoding="ascii") as fh:
+        signer = Ed25519PrivateKey.from_private_bytes(bytes.fromhex(fh.read().strip()))
+    with open(args.applet, "rb") as fh:
+        blob = fh.read()
+    try:
+        check(blob)
+    except ValueError as exc:
+        sys.exit("%s: %s" % (args.applet, exc))
+
+    signature = signer.sign(applet_digest(blob)).hex()
+    print("APPLET %d 0x%08x" % (len(blob), zlib.crc32(blob)))
+    print(" ".join(["RUN", signature] + args.args))
+
+
+if __name__ == "__main__":
+    main()
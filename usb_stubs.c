@@ -485,9 +485,16 @@ static uint8_t cdc_in_buffer[CDC_DATA_EP_SIZE] __attribute__((aligned(4)));
 static uint8_t cdc_notification_buffer[CDC_NOTIFICATION_SIZE] __attribute__((aligned(4)));
 
 // Buffers circulares para CDC
-static uint8_t cdc_rx_buffer[CDC_RX_BUFFER_SIZE];
+static uint8_t cdc_rx_buffer[CDC_RX_BUFFER_SIZE] __attribute__((aligned(4)));
 static uint16_t cdc_rx_head = 0;
 static uint16_t cdc_rx_tail = 0;
+// Cambia con cada reset del bus; usb_cdc_consume() lo compara con el
+// valor visto por usb_cdc_peek() para no liberar datos de otra sesión.
+static uint8_t cdc_rx_generation = 0;
+static uint8_t cdc_rx_peek_generation = 0;
+// Paquete OUT recibido que aún no cabe en el buffer circular; mientras
+// esté pendiente el banco no se rearma y el host recibe NAK.
+static bool cdc_out_pending = false;
 
 static uint8_t cdc_tx_buffer[CDC_TX_BUFFER_SIZE];
 static uint16_t cdc_tx_head = 0;
@@ -627,6 +634,7 @@ static void usb_configure_endpoints(void) {
     USB_DEVICE->DeviceEndpoint[CDC_IN_EP].EPINTENSET = USB_DEVICE_EPINTFLAG_TRCPT1;
 
     cdc_tx_busy = false;
+    cdc_out_pending = false;
 }
 
 static void usb_reset_device(void) {
@@ -635,6 +643,8 @@ static void usb_reset_device(void) {
     usb_control_state.pending_address = 0;
     usb_control_state.phase = CTRL_IDLE;
     cdc_rx_head = cdc_rx_tail = 0;
+    cdc_rx_generation++;
+    cdc_out_pending = false;
     cdc_tx_head = cdc_tx_tail = 0;
     cdc_tx_busy = false;
 
@@ -655,16 +665,23 @@ static void usb_reset_device(void) {
         USB_DEVICE_EPINTFLAG_RXSTP | USB_DEVICE_EPINTFLAG_TRCPT0 | USB_DEVICE_EPINTFLAG_TRCPT1;
 }
 
+// Los índices ya van enmascarados, así que la resta también debe
+// enmascararse. Una posición queda siempre libre para distinguir lleno
+// de vacío.
 static uint16_t usb_ring_rx_count(void) {
-    return (uint16_t)(cdc_rx_head - cdc_rx_tail);
+    return (uint16_t)((cdc_rx_head - cdc_rx_tail) & CDC_RX_BUFFER_MASK);
+}
+
+static uint16_t usb_ring_rx_space(void) {
+    return (uint16_t)(CDC_RX_BUFFER_SIZE - 1u - usb_ring_rx_count());
 }
 
 static uint16_t usb_ring_tx_count(void) {
-    return (uint16_t)(cdc_tx_head - cdc_tx_tail);
+    return (uint16_t)((cdc_tx_head - cdc_tx_tail) & CDC_TX_BUFFER_MASK);
 }
 
 static uint16_t usb_ring_tx_space(void) {
-    return (uint16_t)(CDC_TX_BUFFER_SIZE - usb_ring_tx_count());
+    return (uint16_t)(CDC_TX_BUFFER_SIZE - 1u - usb_ring_tx_count());
 }
 
 static void usb_cdc_try_send(void) {
@@ -861,6 +878,27 @@ static void usb_handle_ep0_in_complete(void) {
     }
 }
 
+// Pasa el paquete pendiente al buffer circular y rearma el banco OUT en
+// cuanto hay sitio. Si no cabe entero se deja para la siguiente llamada:
+// el host ve NAK y reintenta, en lugar de perder datos.
+static void usb_cdc_drain_out(void) {
+    if (!cdc_out_pending) {
+        return;
+    }
+    uint16_t count = (uint16_t)(usb_descriptor_table[CDC_OUT_EP].bank[0].PCKSIZE & USB_PCKSIZE_BYTE_COUNT_Msk);
+    if (usb_ring_rx_space() < count) {
+        return;
+    }
+    for (uint16_t i = 0; i < count; ++i) {
+        cdc_rx_buffer[cdc_rx_head] = cdc_out_buffer[i];
+        cdc_rx_head = (uint16_t)((cdc_rx_head + 1u) & CDC_RX_BUFFER_MASK);
+    }
+    cdc_out_pending = false;
+    usb_descriptor_table[CDC_OUT_EP].bank[0].PCKSIZE = USB_PCKSIZE_SIZE_64;
+    usb_descriptor_table[CDC_OUT_EP].bank[0].STATUS_BK = USB_DEVICE_STATUS_BK_BK_RDY;
+    USB_DEVICE->DeviceEndpoint[CDC_OUT_EP].EPSTATUSCLR = USB_DEVICE_EPSTATUS_BK0RDY;
+}
+
 static void usb_handle_out_endpoint(void) {
     if (!usb_control_state.configured) {
         return;
@@ -868,20 +906,9 @@ static void usb_handle_out_endpoint(void) {
     uint8_t flags = USB_DEVICE->DeviceEndpoint[CDC_OUT_EP].EPINTFLAG;
     if (flags & USB_DEVICE_EPINTFLAG_TRCPT0) {
         USB_DEVICE->DeviceEndpoint[CDC_OUT_EP].EPINTFLAG = USB_DEVICE_EPINTFLAG_TRCPT0;
-        uint16_t count = (uint16_t)(usb_descriptor_table[CDC_OUT_EP].bank[0].PCKSIZE & USB_PCKSIZE_BYTE_COUNT_Msk);
-        for (uint16_t i = 0; i < count; ++i) {
-            uint16_t next_head = (uint16_t)((cdc_rx_head + 1u) & CDC_RX_BUFFER_MASK);
-            if (next_head != cdc_rx_tail) {
-                cdc_rx_buffer[cdc_rx_head] = cdc_out_buffer[i];
-                cdc_rx_head = next_head;
-            } else {
-                break; // overflow, descartamos
-            }
-        }
-        usb_descriptor_table[CDC_OUT_EP].bank[0].PCKSIZE = USB_PCKSIZE_SIZE_64;
-        usb_descriptor_table[CDC_OUT_EP].bank[0].STATUS_BK = USB_DEVICE_STATUS_BK_BK_RDY;
-        USB_DEVICE->DeviceEndpoint[CDC_OUT_EP].EPSTATUSCLR = USB_DEVICE_EPSTATUS_BK0RDY;
+        cdc_out_pending = true;
     }
+    usb_cdc_drain_out();
 }
 
 static void usb_handle_in_endpoint(void) {
@@ -1003,6 +1030,31 @@ int usb_cdc_getchar(void) {
     return value;
 }
 
+// Acceso sin copia al buffer de recepción: devuelve el tramo contiguo
+// disponible (hasta el final del buffer circular) y usb_cdc_consume()
+// lo libera una vez procesado.
+size_t usb_cdc_peek(const uint8_t **data) {
+    uint16_t count = usb_ring_rx_count();
+    uint16_t contiguous = (uint16_t)(CDC_RX_BUFFER_SIZE - cdc_rx_tail);
+    *data = &cdc_rx_buffer[cdc_rx_tail];
+    cdc_rx_peek_generation = cdc_rx_generation;
+    return (count < contiguous) ? count : contiguous;
+}
+
+// Si hubo un reset del bus mientras se procesaba el tramo, los índices
+// ya se pusieron a cero y lo recibido después pertenece a la nueva
+// sesión: no se libera nada. Nunca se avanza más allá de lo recibido.
+void usb_cdc_consume(size_t len) {
+    if (cdc_rx_peek_generation != cdc_rx_generation) {
+        return;
+    }
+    uint16_t count = usb_ring_rx_count();
+    if (len > count) {
+        len = count;
+    }
+    cdc_rx_tail = (uint16_t)((cdc_rx_tail + len) & CDC_RX_BUFFER_MASK);
+}
+
 void usb_cdc_write(const uint8_t *data, size_t len) {
     if (!data || len == 0) {
         return;